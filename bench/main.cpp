@@ -0,0 +1,182 @@
+#include <SDL3/SDL_main.h>
+#include "Lou.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+namespace fs = std::filesystem;
+using Clock_t = std::chrono::steady_clock;
+
+static std::atomic<uint64_t> native_allocations{0};
+void* operator new(std::size_t size) {
+    native_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+struct Workload {
+    std::string_view name;
+    std::string_view script;
+    bool fold_vector_constructors{true};
+    // job system threads, 0 picks the hardware concurrency
+    size_t threads{0};
+    bool native_codegen{false};
+};
+constexpr std::array workloads{
+    Workload{"primitives", "bench/workloads/primitives.luau"},
+    Workload{"text", "bench/workloads/text.luau"},
+    Workload{"text_layout", "bench/workloads/text_layout.luau"},
+    Workload{"texture_blits", "bench/workloads/texture_blits.luau"},
+    Workload{"rotated_sprites", "bench/workloads/rotated_sprites.luau"},
+    Workload{"callback_fan_out", "bench/workloads/callback_fan_out.luau"},
+    Workload{"require_startup", "bench/workloads/require_startup.luau"},
+    Workload{"vector_math", "bench/workloads/vector_math.luau"},
+    Workload{"entities", "bench/workloads/entities.luau"},
+    Workload{"particles", "bench/workloads/particles.luau"},
+    Workload{"tilemap", "bench/workloads/tilemap.luau"},
+    Workload{"spatial_hash_10k", "bench/workloads/spatial_hash_10k.luau"},
+    Workload{"spatial_hash_50k", "bench/workloads/spatial_hash_50k.luau"},
+    Workload{"spatial_hash_100k", "bench/workloads/spatial_hash_100k.luau"},
+    Workload{"vector_constructors", "bench/workloads/vector_constructors.luau"},
+    Workload{"vector_constructors_unfolded", "bench/workloads/vector_constructors.luau", false},
+    Workload{"actors", "bench/workloads/actors.luau"},
+    Workload{"jobs_1_thread", "bench/workloads/jobs.luau", true, 1},
+    Workload{"jobs_2_threads", "bench/workloads/jobs.luau", true, 2},
+    Workload{"jobs_4_threads", "bench/workloads/jobs.luau", true, 4},
+    Workload{"jobs_8_threads", "bench/workloads/jobs.luau", true, 8},
+    Workload{"jobs_all_threads", "bench/workloads/jobs.luau"},
+    Workload{"dynamic_resolution", "bench/workloads/dynamic_resolution.luau"},
+    Workload{"capture", "bench/workloads/capture.luau"},
+    Workload{"typed_subsystems_native", "bench/workloads/typed_subsystems.luau", true, 0, true},
+    Workload{"typed_subsystems_interpreted", "bench/workloads/typed_subsystems.luau"},
+};
+
+struct Options {
+    int frames{300};
+    int warmup_frames{10};
+    std::string filter{};
+    std::string out{"bench_results.json"};
+};
+
+struct Result {
+    std::string_view name;
+    double startup_ms;
+    Lou_State::Frame_Time_Summary frames;
+    uint64_t luau_allocations;
+    uint64_t native_allocations;
+    size_t luau_heap_kb;
+    size_t errors;
+};
+
+static auto parse_options(int argc, char** argv) -> Options {
+    Options options;
+    for (int i{1}; i < argc; ++i) {
+        std::string_view arg{argv[i]};
+        const bool has_value = i + 1 < argc;
+        if (arg == "--frames" and has_value) {
+            options.frames = std::atoi(argv[++i]);
+        } else if (arg == "--warmup" and has_value) {
+            options.warmup_frames = std::atoi(argv[++i]);
+        } else if (arg == "--filter" and has_value) {
+            options.filter = argv[++i];
+        } else if (arg == "--out" and has_value) {
+            options.out = argv[++i];
+        }
+    }
+    return options;
+}
+
+static auto count_errors(Lou_Console& console) -> size_t {
+    console.flush_pending();
+    size_t errors{};
+    for (size_t i{}; i < console.entries.size(); ++i) {
+        const auto& entry = console.entries[i];
+        if (entry.severity != Lou_Console::Severity::Error) continue;
+        if (errors++ == 0) std::println(stderr, "{}", entry.message);
+    }
+    return errors;
+}
+
+static auto run_workload(const Workload& workload, const Options& options) -> Result {
+    using namespace std::chrono;
+    jobs::set_thread_count(workload.threads);
+    auto state = std::make_unique<Lou_State>();
+    const auto startup = Clock_t::now();
+    state->init({
+        .title{std::string(workload.name)},
+        .width = 1280,
+        .height = 720,
+        .flags = 0,
+        .script_entry_point = std::string(workload.script),
+        .video_driver = "offscreen",
+        .render_driver = "software",
+        .fold_vector_constructors = workload.fold_vector_constructors,
+        .native_codegen = workload.native_codegen,
+        .collect_frame_times = true,
+    });
+    const double startup_ms = duration<double, std::milli>(Clock_t::now() - startup).count();
+    for (int i{}; i < options.warmup_frames; ++i) {
+        state->update();
+        state->render();
+    }
+    state->frame.work_ms.clear();
+    const uint64_t luau_before = state->memory.allocations;
+    const uint64_t native_before = native_allocations.load(std::memory_order_relaxed);
+    for (int i{}; i < options.frames and state->running; ++i) {
+        state->update();
+        state->render();
+    }
+    return {
+        .name = workload.name,
+        .startup_ms = startup_ms,
+        .frames = state->frame_time_summary(),
+        .luau_allocations = state->memory.allocations - luau_before,
+        .native_allocations = native_allocations.load(std::memory_order_relaxed) - native_before,
+        .luau_heap_kb = static_cast<size_t>(lua_gc(state->lua_state(), LUA_GCCOUNT, 0)),
+        .errors = count_errors(state->console),
+    };
+}
+
+static auto to_json(const Options& options, const std::vector<Result>& results) -> std::string {
+    std::string json = std::format(
+        "{{\n  \"renderer\": \"software\",\n  \"frames\": {},\n  \"workloads\": [\n",
+        options.frames
+    );
+    for (const auto& r : results) {
+        json += std::format(
+            "    {{\"name\": \"{}\", \"startup_ms\": {:.3f}, \"frames\": {}, "
+            "\"mean_ms\": {:.4f}, \"p50_ms\": {:.4f}, \"p95_ms\": {:.4f}, \"p99_ms\": {:.4f}, \"max_ms\": {:.4f}, "
+            "\"luau_allocations\": {}, \"native_allocations\": {}, \"luau_heap_kb\": {}, \"errors\": {}}},\n",
+            r.name, r.startup_ms, r.frames.frames,
+            r.frames.mean_ms, r.frames.p50_ms, r.frames.p95_ms, r.frames.p99_ms, r.frames.max_ms,
+            r.luau_allocations, r.native_allocations, r.luau_heap_kb, r.errors
+        );
+    }
+    if (json.ends_with(",\n")) json.resize(json.size() - 2);
+    json += "\n  ]\n}\n";
+    return json;
+}
+
+auto main(int argc, char** argv) -> int {
+    auto options = parse_options(argc, argv);
+    const auto out = fs::absolute(options.out);
+    // workloads and resources are addressed relative to the repository root
+    fs::current_path(LOU_SOURCE_DIR);
+    std::vector<Result> results;
+    for (const auto& workload : workloads) {
+        if (not options.filter.empty() and not workload.name.contains(options.filter)) continue;
+        auto& r = results.emplace_back(run_workload(workload, options));
+        std::println("{:<20} p50 {:8.3f}ms  p99 {:8.3f}ms  luau allocs {:>10}  errors {}",
+            r.name, r.frames.p50_ms, r.frames.p99_ms, r.luau_allocations, r.errors);
+    }
+    std::ofstream file{out};
+    file << to_json(options, results);
+    std::println("results written to '{}'", out.string());
+    SDL_Quit();
+    return 0;
+}
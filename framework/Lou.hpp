@@ -6,12 +6,25 @@
 #include <imgui_impl_sdlrenderer3.h>
 #include <imgui.h>
 #include <memory>
+#include <optional>
+#include <numbers>
+#include <random>
+#include <unordered_map>
 #include <expected>
 #include <string>
 #include <lualib.h>
 #include <chrono>
 #include <print>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
 #include "common.hpp"
+#include "concurrent.hpp"
+#include "jobs.hpp"
 #include <blaze/Blaze.h>
 #include <Luau/Compiler.h>
 #include <luacode.h>
@@ -33,6 +46,9 @@ constexpr auto as_point(Vector_t v) -> SDL_FPoint {
 struct Lou_Callback_Handle {
     lua::Basic_Callback_List* callback;
     lua::Basic_Callback_List::Id id;
+    // set when `callback` belongs to a collectable userdata, which then
+    // can't be collected while the handle is still around.
+    lua::Ref owner{};
     void unbind() {
         if (callback) callback->remove(id);
         callback = nullptr;
@@ -49,13 +65,30 @@ struct Lou_Callback_Handle {
 struct Lou_Texture {
     C_Owner_t<SDL_Texture> ptr{nullptr, SDL_DestroyTexture};
     lua::Ref cached_color_ref;
+    // the draw function of a render target lives in a metatable of its own
+    // instead of a registry ref, so the gc sees through it and a closure
+    // capturing its texture doesn't keep the pair alive forever.
+    bool render_target{false};
+    bool dirty{false};
+    // the size never changes and the color mod is only set through here,
+    // so both are mirrored to keep property reads away from SDL.
+    SDL_FPoint size{};
+    SDL_FColor color{1, 1, 1, 1};
+    static auto from(SDL_Texture* texture) -> Lou_Texture {
+        Lou_Texture result{.ptr{texture, SDL_DestroyTexture}};
+        SDL_GetTextureSize(texture, &result.size.x, &result.size.y);
+        return result;
+    }
     static void push_metatable(lua_State* L);
-    auto source_rect() -> std::expected<SDL_FRect, std::string> const {
-        float w, h;
-        if (!SDL_GetTextureSize(ptr.get(), &w, &h)) {
-            return std::unexpected(SDL_GetError());
-        } 
-        return SDL_FRect{0, 0, w, h};
+    // `idx` is this texture's userdata, `fn_idx` the function drawing it.
+    auto set_draw_fn(lua_State* L, int idx, int fn_idx) -> void;
+    auto redraw(lua_State* L) -> std::expected<void, std::string>;
+    auto redraw_if_dirty(lua_State* L) -> std::expected<void, std::string> {
+        if (not dirty or not render_target) return {};
+        return redraw(L);
+    }
+    constexpr auto source_rect() const -> SDL_FRect {
+        return {0, 0, size.x, size.y};
     }
     constexpr auto get() -> SDL_Texture* const {
         return ptr.get();
@@ -63,34 +96,65 @@ struct Lou_Texture {
 };
 
 struct Lou_Font {
-    C_Owner_t<TTF_Font> ptr{nullptr, TTF_CloseFont};
-    auto open(const std::string& file, float font_size) -> std::expected<void, std::string> {
-        ptr.reset(TTF_OpenFont(file.c_str(), font_size));
-        if (not ptr) return std::unexpected(SDL_GetError());
-
-        return {};
-    };
+    std::shared_ptr<TTF_Font> ptr;
     static void push_metatable(lua_State* L);
     static void push_constructor(lua_State* L);
 };
+// fonts are shared per (resolved path, size) and every size of a file is
+// opened from the same bytes, so each file is read and kept only once.
+// both maps only observe, the handles and their fonts own everything.
+struct Lou_Fonts {
+    static constexpr size_t layout_capacity = 1024;
+    struct Stats {
+        size_t files;
+        size_t fonts;
+        size_t file_bytes;
+    };
+    // shaped and wrapped text, drawn straight from its glyph positions.
+    // the font is held so it outlives the text made from it.
+    struct Layout {
+        std::shared_ptr<TTF_Font> font;
+        std::string text;
+        int wrap_width;
+        size_t hash;
+        C_Owner_t<TTF_Text> ptr{nullptr, TTF_DestroyText};
+        int width;
+        int height;
+    };
+    std::unordered_map<std::string, std::weak_ptr<const std::string>> files;
+    std::map<std::pair<std::string, float>, std::weak_ptr<TTF_Font>> fonts;
+    // most recently used first, the last one goes once the cache is full
+    std::list<Layout> layouts;
+    std::unordered_multimap<size_t, std::list<Layout>::iterator> layout_index;
+    auto open(const std::filesystem::path& file, float size) -> std::expected<std::shared_ptr<TTF_Font>, std::string>;
+    // 0 as wrap width only breaks lines at newlines.
+    auto layout(TTF_TextEngine* engine, const std::shared_ptr<TTF_Font>& font, std::string_view text, int wrap_width) -> std::expected<Layout*, std::string>;
+    auto stats() -> Stats;
+};
 
 
 struct Lou_Console {
+    static constexpr size_t default_capacity = 4096;
     auto render() -> void;
     enum class Severity {
         Comment, Warning, Error
     };
     struct Entry {
         Severity severity;
+        std::chrono::system_clock::time_point time;
         std::string message;
     };
-    std::vector<Entry> entries{};
+    Ring_Buffer<Entry> entries{default_capacity};
+    concurrent::Mpsc_Queue<Entry> pending;
     bool open{true};
+    // scrolls to the newest entry, only consumed while the console is open.
     bool is_dirty{false};
+    // new entries since the last rendered frame, cleared by Lou_State::render.
+    bool changed{false};
+    // safe to call from any thread, entries become visible on the next flush.
     template <Severity Severity>
     auto basic_print(const std::string& message) -> void {
-        entries.emplace_back(Severity, stamp_time() + std::string(message));
-        is_dirty = true;
+        pending.push(Severity, std::chrono::system_clock::now(), message);
     }
     auto comment(const std::string& message) -> void {
         return basic_print<Severity::Comment>(message);
@@ -101,6 +165,7 @@ struct Lou_Console {
     auto error(const std::string& message) -> void {
         return basic_print<Severity::Error>(message);
     }
+    auto flush_pending() -> void;
     static auto push_metatable(lua_State* L) -> void;
 };
 
@@ -110,6 +175,7 @@ struct Lou_Keyboard {
     static void push_metatable(lua_State* L);
 };
 struct Lou_Mouse {
+    SDL_FPoint position{};
     lua::Callback_List<const std::string&, float, float> pressed;
     lua::Callback_List<const std::string&, float, float> released;
     lua::Callback_List<float, float> moved;
@@ -124,18 +190,121 @@ struct Lou_Window {
     static void push_metatable(lua_State* L);
 };
 
+// frames are read back on the render thread and encoded on a worker. the
+// readbacks are converted into pooled surfaces, and continuous capture drops
+// a frame rather than queueing more than `max_queued` of them.
+struct Lou_Capture {
+    static constexpr size_t max_queued = 4;
+    static constexpr auto default_file = "lou_capture.png";
+    enum class Format {Png, Raw};
+    struct Frame {
+        C_Owner_t<SDL_Surface> surface{nullptr, SDL_DestroySurface};
+        std::filesystem::path file;
+        Format format;
+    };
+    struct Stats {
+        uint64_t written;
+        uint64_t dropped;
+        uint64_t failed;
+    };
+    struct Continuous {
+        bool active{false};
+        std::filesystem::path directory;
+        Format format{Format::Png};
+        uint64_t next_frame{0};
+    };
+    std::vector<std::filesystem::path> requested;
+    Continuous continuous;
+    struct {
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<Frame> frames;
+        std::vector<C_Owner_t<SDL_Surface>> pool;
+        std::vector<std::string> errors;
+        bool stopping{false};
+    } queue;
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> failed{0};
+    uint64_t reported_failures{0};
+    // started with the first captured frame
+    std::thread worker;
+    Lou_Capture() = default;
+    Lou_Capture(const Lou_Capture&) = delete;
+    Lou_Capture& operator=(const Lou_Capture&) = delete;
+    // pending frames are still written before this returns
+    ~Lou_Capture();
+    // the format follows the extension, anything but .png is dumped raw.
+    auto request(std::filesystem::path file) -> void;
+    auto start(std::filesystem::path directory, Format format) -> std::expected<void, std::string>;
+    auto stop() -> void;
+    auto stats() const -> Stats;
+    // reads the current render target, raw dumps are tightly packed RGBA32.
+    auto read_frame(SDL_Renderer* renderer, Lou_Console& console) -> void;
+private:
+    auto pooled_surface(int width, int height) -> C_Owner_t<SDL_Surface>;
+    auto run() -> void;
+};
+
 struct Lou_Renderer {
+    struct Sprite {
+        SDL_FRect source;
+        SDL_FRect destination;
+        double angle{0};
+        // relative to the destination, defaults to its center
+        std::optional<SDL_FPoint> pivot{};
+        SDL_FlipMode flip{SDL_FLIP_NONE};
+    };
+    static constexpr size_t max_batch_vertices = 4 * 4096;
     struct {
         C_Owner_t<SDL_Renderer> renderer{nullptr, SDL_DestroyRenderer};
         C_Owner_t<TTF_TextEngine> text_engine{nullptr, TTF_DestroyRendererTextEngine};
     } owning;
+    // consecutive sprites of the same texture are collected here and
+    // submitted as a single SDL_RenderGeometry call. anything else that
+    // draws or changes the render target has to flush first.
+    struct {
+        SDL_Texture* texture{nullptr};
+        std::vector<SDL_Vertex> vertices;
+        std::vector<int> indices;
+    } batch;
+    // when enabled the scene is drawn into `target` at `scale` of the output
+    // size and stretched over the window. the controller nudges the scale to
+    // keep the smoothed frame time under budget.
+    struct Dynamic_Resolution {
+        static constexpr float step = .05f;
+        static constexpr float smoothing = .1f;
+        // the scale only goes back up once there is this much headroom
+        static constexpr float headroom = .8f;
+        // frames to wait after a change before the next one
+        static constexpr int settle_frames = 10;
+        bool enabled{false};
+        float budget_ms{1000.f / 60};
+        float min_scale{.5f};
+        float max_scale{1};
+        float scale{1};
+        float average_ms{0};
+        int cooldown{0};
+        std::optional<Lou_Texture> target;
+    } resolution;
+    Lou_Capture capture;
     constexpr auto get() -> SDL_Renderer* const {return owning.renderer.get();}
     constexpr auto get_text_engine() -> TTF_TextEngine* const {return owning.text_engine.get();}
+    auto draw_sprite(const Lou_Texture& texture, const Sprite& sprite) -> bool;
+    auto flush() -> bool;
+    auto release(SDL_Texture* texture) -> void {
+        if (batch.texture == texture) flush();
+    }
+    // redirects drawing into the scaled target, false if it isn't enabled.
+    auto begin_scaled_frame() -> std::expected<bool, std::string>;
+    auto present_scaled_frame() -> bool;
+    auto update_resolution(float frame_ms) -> void;
     static void push_metatable(lua_State* L);
 };
 struct Lou_Create_Texture {
     SDL_Renderer* renderer;
     auto render_text_blended(const Lou_Font& font, std::string_view text, SDL_FColor color) -> std::expected<Lou_Texture, std::string> {
+        LOU_TRACE_SCOPE("texture upload (text)");
         auto cast = [](float v) {
             return static_cast<Uint8>(std::clamp(v * 255, 0.f, 255.f));
         };
@@ -147,31 +316,423 @@ struct Lou_Create_Texture {
         ), SDL_DestroySurface);
         auto texture = SDL_CreateTextureFromSurface(renderer, surface.get());
         if (not texture) return std::unexpected{SDL_GetError()};
-        return Lou_Texture{
-            .ptr{texture, SDL_DestroyTexture},
-        };
+        return Lou_Texture::from(texture);
     }
     auto load_image(const char* file) -> std::expected<Lou_Texture, std::string> {
+        LOU_TRACE_SCOPE("texture upload (image)");
         auto texture = IMG_LoadTexture(renderer, file);
         if (not texture) return std::unexpected(SDL_GetError());
-        return Lou_Texture{
-            .ptr{texture, SDL_DestroyTexture},
+        return Lou_Texture::from(texture);
+    }
+    auto render_target(int w, int h) -> std::expected<Lou_Texture, std::string> {
+        auto texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, w, h);
+        if (not texture) return std::unexpected(SDL_GetError());
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        return Lou_Texture::from(texture);
+    }
+    auto solid_color(SDL_FColor color, int w, int h) -> std::expected<Lou_Texture, std::string> {
+        LOU_TRACE_SCOPE("texture upload (solid color)");
+        auto surface = C_Owner_t<SDL_Surface>(SDL_CreateSurface(w, h, SDL_PIXELFORMAT_RGBA32), SDL_DestroySurface);
+        if (not surface) return std::unexpected(SDL_GetError());
+        auto cast = [](float v) {
+            return static_cast<Uint8>(std::clamp(v * 255, 0.f, 255.f));
         };
+        auto details = SDL_GetPixelFormatDetails(surface->format);
+        auto pixel = SDL_MapRGBA(details, nullptr, cast(color.r), cast(color.g), cast(color.b), cast(color.a));
+        if (not SDL_FillSurfaceRect(surface.get(), nullptr, pixel)) return std::unexpected(SDL_GetError());
+        auto texture = SDL_CreateTextureFromSurface(renderer, surface.get());
+        if (not texture) return std::unexpected(SDL_GetError());
+        return Lou_Texture::from(texture);
+    }
+    static void push_metatable(lua_State* L);
+};
+
+struct Lou_Math {
+    // points are packed as interleaved x, y floats inside of a luau buffer.
+    using Points_t = std::span<float>;
+    static auto to_points(lua_State* L, int idx) -> Points_t;
+    static auto transform(Points_t points, Vector_t linear, SDL_FPoint offset) -> void;
+    static auto translate(Points_t points, SDL_FPoint offset) -> void;
+    static auto scale(Points_t points, SDL_FPoint factor, SDL_FPoint pivot) -> void;
+    static auto rotate(Points_t points, float radians, SDL_FPoint pivot) -> void;
+    static auto bounds(std::span<const float> points) -> SDL_FRect;
+    static auto cull_points(std::span<const float> points, SDL_FRect view, Points_t out) -> size_t;
+    static auto cull_rects(std::span<const float> rects, SDL_FRect view, std::span<uint32_t> out) -> size_t;
+    static void push_metatable(lua_State* L);
+};
+
+struct Lou_Jobs {
+    // built-in kernels over buffers of float elements `stride` floats apart.
+    // they are spread over the job system and only touch the leading lanes.
+    using Lanes_t = std::array<float, LUA_VECTOR_SIZE>;
+    static constexpr size_t grain = 4096;
+    static auto translate(std::span<float> data, size_t stride, Lanes_t offset) -> void;
+    static auto scale(std::span<float> data, size_t stride, Lanes_t factor) -> void;
+    static auto clamp(std::span<float> data, size_t stride, Lanes_t min, Lanes_t max) -> void;
+    // elements start with x, y, vx, vy
+    static auto integrate(std::span<float> data, size_t stride, float delta_seconds) -> void;
+    static auto transform(std::span<float> data, size_t stride, Lanes_t linear, SDL_FPoint offset) -> void;
+    static void push_metatable(lua_State* L);
+};
+
+struct Lou_Trace {
+    static constexpr auto default_file = "lou_trace.json";
+    std::vector<std::pair<const char*, uint64_t>> open_scopes;
+    auto begin(std::string_view name) -> void {
+        if (not tracing::enabled()) return;
+        open_scopes.emplace_back(tracing::intern(name), tracing::now());
+    }
+    auto finish() -> void {
+        if (open_scopes.empty()) return;
+        auto [name, start_ns] = open_scopes.back();
+        open_scopes.pop_back();
+        tracing::record(name, start_ns, tracing::now());
+    }
+    auto toggle_capture(Lou_Console& console) -> void;
+    static void push_metatable(lua_State* L);
+};
+
+struct Lou_Profiler {
+    // a timer thread raises `sample_requested` every interval and the vm's
+    // interrupt callback records the luau stack at its next safepoint.
+    static constexpr auto default_file = "lou_profile.folded";
+    static constexpr std::chrono::microseconds default_interval{1000};
+    static constexpr int window_frames = 60;
+    static constexpr size_t top_count = 32;
+    struct Function_Samples {
+        std::string name;
+        uint64_t self;
+        uint64_t total;
+    };
+    std::atomic<bool> sampling{false};
+    std::atomic<bool> sample_requested{false};
+    std::atomic<uint64_t> requested_ns{0};
+    std::chrono::microseconds interval{default_interval};
+    std::thread timer;
+    // folded stacks of the whole capture, `outer;caller;callee` -> samples
+    std::unordered_map<std::string, uint64_t> stacks;
+    uint64_t samples{0};
+    // per function samples of the current window of frames
+    std::unordered_map<std::string, Function_Samples> window;
+    uint64_t window_samples{0};
+    int window_frame{0};
+    // the hottest functions of the last complete window
+    std::vector<Function_Samples> top;
+    uint64_t top_samples{0};
+    std::vector<std::string> frames;
+    bool open{false};
+    Lou_Profiler() = default;
+    Lou_Profiler(const Lou_Profiler&) = delete;
+    Lou_Profiler& operator=(const Lou_Profiler&) = delete;
+    ~Lou_Profiler();
+    auto start(lua_State* L, std::chrono::microseconds interval) -> void;
+    auto stop(lua_State* L) -> void;
+    auto sample(lua_State* L) -> void;
+    auto end_frame() -> void;
+    auto dump(const std::filesystem::path& file) -> std::expected<size_t, std::string>;
+    auto toggle_capture(lua_State* L, Lou_Console& console) -> void;
+    auto render() -> void;
+    static void push_metatable(lua_State* L);
+private:
+    auto close_window() -> void;
+};
+
+// F7 panel over lua::ref_audit, groups the live registry refs by the
+// subsystem and script line that created them.
+struct Lou_Refs {
+    static constexpr auto default_file = "lou_refs.txt";
+    // what a ref keeps from being collected, values reachable from several
+    // refs count towards each of them.
+    struct Retained {
+        size_t tables{};
+        size_t functions{};
+        size_t userdata{};
+        size_t string_bytes{};
+        size_t buffer_bytes{};
+    };
+    bool open{false};
+    static auto subsystem(int tag) -> std::string_view;
+    auto dump(lua_State* L, const std::filesystem::path& file) -> std::expected<size_t, std::string>;
+    auto render(lua_State* L, Lou_Console& console) -> void;
+};
+
+struct Lou_Replay {
+    enum class Mode {
+        Off, Record, Replay
+    };
+    static constexpr std::array<char, 4> magic{'L', 'O', 'U', 'R'};
+    static constexpr uint32_t version = 1;
+    Mode mode{Mode::Off};
+    std::ofstream output;
+    std::ifstream input;
+    uint64_t seed{};
+    double fixed_delta{};
+    std::vector<SDL_Event> frame_events;
+    auto start_recording(const std::filesystem::path& file) -> std::expected<void, std::string>;
+    auto start_replay(const std::filesystem::path& file, double fixed_delta) -> std::expected<void, std::string>;
+    auto record_event(const SDL_Event& e) -> void;
+    auto end_frame(double delta_seconds) -> void;
+    // reads the next frame into frame_events, false once the recording ran out.
+    auto next_frame(double& delta_seconds) -> bool;
+    static auto is_recordable(const SDL_Event& e) -> bool;
+};
+
+struct Lou_Entities {
+    // ids pack a slot with its generation, so ids of removed entities go
+    // stale instead of aliasing whatever entity reuses the slot later.
+    using Id = uint32_t;
+    static constexpr int slot_bits = 20;
+    static constexpr Id slot_mask = (Id{1} << slot_bits) - 1;
+    static constexpr uint32_t generation_mask = (uint32_t{1} << (32 - slot_bits)) - 1;
+    static constexpr uint32_t no_index = std::numeric_limits<uint32_t>::max();
+    static constexpr float forever = std::numeric_limits<float>::infinity();
+    static constexpr size_t parallel_grain = 8192;
+    struct Sprite {
+        Lou_Texture* texture{nullptr};
+        SDL_FPoint size{};
+        float angle{0};
+    };
+    struct Texture_Use {
+        lua::Ref ref;
+        uint32_t users{0};
+    };
+    // component columns, index i of every column belongs to the entity ids[i].
+    std::vector<Id> ids;
+    std::vector<SDL_FPoint> position;
+    std::vector<SDL_FPoint> velocity;
+    std::vector<Sprite> sprite;
+    std::vector<float> lifetime;
+    // per slot
+    std::vector<uint32_t> dense_index;
+    std::vector<uint32_t> generation;
+    std::vector<uint32_t> free_slots;
+    // keeps the textures referenced by sprites alive
+    std::unordered_map<Lou_Texture*, Texture_Use> textures;
+    std::vector<Id> expired_ids;
+    lua::Callback_List<double> expired;
+    auto size() const -> size_t {return ids.size();}
+    auto spawn(SDL_FPoint position, SDL_FPoint velocity, float lifetime) -> std::expected<Id, std::string>;
+    auto find(Id id) const -> std::optional<size_t>;
+    auto remove(Id id) -> bool;
+    // the texture is expected at `idx` so it can be referenced.
+    auto set_sprite(lua_State* L, size_t index, int idx, SDL_FPoint size, float angle) -> void;
+    auto clear() -> void;
+    auto update(lua_State* L, Lou_Console& console, double delta_seconds) -> void;
+    auto render(lua_State* L, Lou_Renderer& renderer, Lou_Console& console) -> void;
+    static void push_metatable(lua_State* L);
+private:
+    auto release_texture(Lou_Texture* texture) -> void;
+};
+
+struct Lou_Emitter {
+    struct Range {
+        float min;
+        float max;
+    };
+    static constexpr size_t parallel_grain = 16384;
+    // particle columns sized to the capacity up front. only the first `live`
+    // entries are alive, dead ones get swapped with the last live particle.
+    size_t capacity;
+    size_t live{0};
+    std::vector<float> x, y, vx, vy;
+    // normalized age in [0, 1) and how much of it passes per second
+    std::vector<float> age, age_rate;
+    Range lifetime{1, 1};
+    Range speed{50, 100};
+    float direction{0};
+    float spread{2 * std::numbers::pi_v<float>};
+    SDL_FPoint gravity{};
+    Range size{8, 8};
+    SDL_FColor start_color{1, 1, 1, 1};
+    SDL_FColor end_color{1, 1, 1, 0};
+    Lou_Texture* texture{nullptr};
+    lua::Ref texture_ref;
+    std::minstd_rand random;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    Lou_Emitter(size_t capacity, uint32_t seed);
+    auto burst(SDL_FPoint position, size_t count) -> size_t;
+    auto update(float delta_seconds) -> void;
+    auto render(Lou_Renderer& renderer) -> bool;
+    static void push_metatable(lua_State* L);
+};
+struct Lou_Particles {
+    // emitters are owned by their userdata and register themselves here
+    std::vector<Lou_Emitter*> emitters;
+    uint32_t next_seed{1};
+    auto update(double delta_seconds) -> void;
+    auto forget(Lou_Emitter* emitter) -> void {
+        std::erase(emitters, emitter);
+    }
+    static void push_metatable(lua_State* L);
+};
+
+struct Lou_Tilemap {
+    // tiles are stored as 1-based indices into the tileset, 0 is empty.
+    static constexpr int chunk_tiles = 16;
+    // baked chunks beyond this many bytes of textures are evicted, least
+    // recently drawn first. chunks drawn in the current render are kept even
+    // when they alone exceed it.
+    static constexpr size_t baked_budget_bytes = 64 << 20;
+    struct Chunk {
+        std::optional<Lou_Texture> texture;
+        uint16_t filled{0};
+        bool dirty{true};
+        uint64_t last_drawn{0};
+    };
+    int width;
+    int height;
+    SDL_FPoint tile_size;
+    Lou_Texture* tileset;
+    lua::Ref tileset_ref;
+    std::vector<uint16_t> tiles;
+    int chunk_columns;
+    int chunk_rows;
+    std::vector<Chunk> chunks;
+    // indices of the chunks holding a texture
+    std::vector<int> baked;
+    uint64_t render_count{0};
+    Lou_Tilemap(Lou_Texture& tileset, lua::Ref tileset_ref, SDL_FPoint tile_size, int width, int height);
+    auto tile_count() const -> int {
+        return static_cast<int>(tileset->size.x / tile_size.x) * static_cast<int>(tileset->size.y / tile_size.y);
+    }
+    auto chunk_of(int x, int y) -> Chunk& {
+        return chunks[(y / chunk_tiles) * chunk_columns + x / chunk_tiles];
+    }
+    auto set(int x, int y, uint16_t tile) -> void;
+    auto invalidate() -> void {
+        for (auto& chunk : chunks) chunk.dirty = true;
     }
+    // draws the chunks intersecting `view`, with the map's top left at `position`.
+    auto render(Lou_Renderer& renderer, SDL_FPoint position, SDL_FRect view) -> std::expected<void, std::string>;
     static void push_metatable(lua_State* L);
+private:
+    auto bake(Lou_Renderer& renderer, int chunk_x, int chunk_y) -> std::expected<void, std::string>;
+    auto evict_for_bake(Lou_Renderer& renderer) -> void;
 };
 
+struct Lou_Spatial_Hash {
+    // uniform grid broad phase. bodies are indexed by every cell their rect
+    // overlaps, queries only visit the cells the query touches.
+    using Id = uint32_t;
+    struct Cell_Range {
+        int x0, y0, x1, y1;
+        constexpr auto operator==(const Cell_Range&) const -> bool = default;
+    };
+    struct Body {
+        SDL_FRect rect;
+        Cell_Range cells;
+        bool alive;
+        bool oversized;
+    };
+    // bodies covering more cells than this go to `oversized` instead of the
+    // grid and are tested against every query.
+    static constexpr uint64_t max_body_cells = 1024;
+    float cell_size;
+    std::vector<Body> bodies;
+    std::vector<Id> free_ids;
+    std::unordered_map<uint64_t, std::vector<Id>> cells;
+    std::vector<Id> oversized;
+    // deduplicates bodies spanning several cells within a single query
+    std::vector<uint32_t> visited;
+    uint32_t query_stamp{0};
+    explicit Lou_Spatial_Hash(float cell_size): cell_size(cell_size) {}
+    auto count() const -> size_t {return bodies.size() - free_ids.size();}
+    auto contains(Id id) const -> bool {return id < bodies.size() and bodies[id].alive;}
+    auto insert(SDL_FRect rect) -> Id;
+    auto move(Id id, SDL_FRect rect) -> void;
+    auto remove(Id id) -> void;
+    // the query functions write as many ids as fit into `out` and return that count.
+    auto query_point(SDL_FPoint point, std::span<Id> out) -> size_t;
+    auto query_rect(SDL_FRect rect, std::span<Id> out) -> size_t;
+    // overlapping pairs are written as consecutive ids, returns the pair count.
+    auto pairs(std::span<Id> out) -> size_t;
+    static void push_metatable(lua_State* L);
+    static void push_constructor(lua_State* L);
+private:
+    auto cell_range(SDL_FRect rect) const -> Cell_Range;
+    auto link(Id id) -> void;
+    auto unlink(Id id) -> void;
+    auto next_stamp() -> uint32_t;
+};
+
+struct Lou_Actor {
+    // a message holds every value of one send or post serialized into a single
+    // blob, which is moved between the threads instead of being copied again.
+    using Message = std::string;
+    std::filesystem::path script;
+    Lou_Console* console;
+    struct {
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<Message> messages;
+    } inbox;
+    concurrent::Mpsc_Queue<Message> outbox;
+    // stopping is only set while holding the inbox mutex
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> finished{false};
+    lua::Basic_Callback_List received;
+    // declared last, the worker starts once everything else is constructed.
+    std::thread worker;
+    Lou_Actor(std::filesystem::path script, Lou_Console& console);
+    Lou_Actor(const Lou_Actor&) = delete;
+    Lou_Actor& operator=(const Lou_Actor&) = delete;
+    ~Lou_Actor();
+    auto send(Message message) -> void;
+    auto stop() -> void;
+    // serializes the values from `first` to the top of the stack.
+    static auto serialize(lua_State* L, int first) -> std::expected<Message, std::string>;
+    // pushes the values of `message` and returns how many there are.
+    static auto deserialize(lua_State* L, std::string_view message) -> int;
+    static void push_metatable(lua_State* L);
+private:
+    auto run() -> void;
+};
+struct Lou_Actors {
+    // running actors are referenced so they can't be collected while their
+    // worker is alive, they are let go once it finished and got drained.
+    struct Running {
+        Lou_Actor* actor;
+        lua::Ref ref;
+    };
+    std::vector<Running> running;
+    // delivers the messages posted by the workers to the received handlers.
+    auto update(lua_State* L, Lou_Console& console) -> void;
+    static void push_metatable(lua_State* L);
+};
+
+// a plain sandboxed vm for code running off the main thread, it only has
+// the standard libraries, require, the vector constructors and `globals`.
+auto new_worker_luau(Lou_Console& console, void* userdata, const luaL_Reg* globals) -> C_Owner_t<lua_State>;
+// compile options shared by the entry point, require and loadstring.
+auto copts() -> Luau::CompileOptions;
+// compiles the function at `idx` natively when native codegen is enabled.
+auto compile_native(lua_State* L, int idx) -> void;
+// userdata member accesses and namecalls the native compiler resolved to a
+// result type so far. the calls themselves still go through the metamethods.
+auto typed_results_report() -> std::string;
+
 struct Lou_State {
     static constexpr auto global_name = "lou";
     struct {
-        C_Owner_t<lua_State> luau{nullptr, lua_close};
+        C_Owner_t<lua_State> luau{nullptr, lua::close};
     } owning;
     Lou_Window window;
     Lou_Renderer renderer;
     Lou_Create_Texture texture;
+    Lou_Fonts fonts;
     Lou_Console console;
     Lou_Keyboard keyboard;
     Lou_Mouse mouse;
+    Lou_Math math;
+    Lou_Trace trace;
+    Lou_Profiler profiler;
+    Lou_Refs refs;
+    Lou_Replay replay;
+    Lou_Entities entities;
+    Lou_Particles particles;
+    Lou_Actors actors;
+    Lou_Jobs jobs;
     std::vector<Lou_Callback_Handle> destroyed_callbacks;
     using Clock_t = std::chrono::steady_clock;
     using Time_Point_t = std::chrono::time_point<Clock_t>;
@@ -182,18 +743,71 @@ struct Lou_State {
     lua::Callback_List<double> on_update;
     lua::Callback_List<void> on_render;
     bool running{true};
+    // ImGui needs a couple of frames after input before its state settles.
+    static constexpr int settle_frame_count = 3;
+    struct {
+        bool idle_mode{false};
+        int idle_timeout_ms{500};
+        int settle_frames{settle_frame_count};
+        bool redraw_requested{true};
+        uint64_t rendered{};
+        uint64_t skipped{};
+        std::chrono::steady_clock::time_point work_start{};
+        // only kept when someone reports them, it grows by one every frame
+        bool collect_work_ms{false};
+        std::vector<float> work_ms;
+    } frame;
+    struct {
+        uint64_t allocations{};
+        uint64_t frees{};
+    } memory;
+    struct Frame_Time_Summary {
+        size_t frames;
+        double mean_ms;
+        double p50_ms;
+        double p95_ms;
+        double p99_ms;
+        double max_ms;
+    };
     struct Init_Info {
         std::string title{"engine"};
         int width{800};
         int height{600};
         SDL_WindowFlags flags{SDL_WINDOW_RESIZABLE};
         std::string script_entry_point{"game/init.luau"};
+        bool idle_mode{false};
+        std::string record_file{};
+        std::string replay_file{};
+        double replay_delta{1.0 / 60.0};
+        std::string video_driver{};
+        std::string render_driver{};
+        bool fold_vector_constructors{true};
+        bool native_codegen{false};
+        // always on while recording or replaying
+        bool collect_frame_times{false};
     };
+    // read by copts(), applies to every chunk compiled afterwards.
+    static inline bool fold_vector_constructors{true};
+    static inline bool native_codegen{false};
+    Lou_State() = default;
+    Lou_State(const Lou_State&) = delete;
+    Lou_State& operator=(const Lou_State&) = delete;
+    ~Lou_State();
     void init(Init_Info data);
     void init_luau();
     void update();
     void render();
+    auto needs_redraw() -> bool;
+    auto bind_subsystems(lua_State* L) -> void;
+    auto frame_time_summary() -> Frame_Time_Summary;
+    auto frame_time_report() -> std::string;
+    void process_event(SDL_Event& e);
     constexpr auto lua_state() -> lua_State* {return owning.luau.get();}
+    // every thread of the vm shares the callbacks, so this holds for
+    // coroutines and required modules too and can't be shadowed by scripts.
+    static auto from(lua_State* L) -> Lou_State& {
+        return *static_cast<Lou_State*>(lua_callbacks(L)->userdata);
+    }
     static auto push_metatable(lua_State* L) -> void;
 };
 
@@ -264,6 +878,72 @@ enum class Namecall_Atom: int16_t {
     is_down,
     is_key_down,
     moved,
+    translate,
+    scale,
+    rotate,
+    transform,
+    bounds,
+    cull_points,
+    cull_rects,
+    from_solid_color,
+    invalidate,
+    redraw,
+    request_redraw,
+    set_idle_mode,
+    frame_stats,
+    begin,
+    finish,
+    start,
+    stop,
+    dump,
+    color,
+    x,
+    y,
+    spawn,
+    alive,
+    count,
+    expired,
+    velocity,
+    lifetime,
+    set_position,
+    set_velocity,
+    set_lifetime,
+    set_sprite,
+    emitter,
+    burst,
+    set_speed,
+    set_direction,
+    set_gravity,
+    set_sizes,
+    set_colors,
+    set_texture,
+    tilemap,
+    set,
+    get,
+    fill,
+    insert,
+    query_point,
+    query_rect,
+    pairs,
+    typed_results,
+    send,
+    received,
+    parallel_for,
+    thread_count,
+    set_thread_count,
+    integrate,
+    clamp,
+    dynamic_resolution,
+    resolution_scale,
+    samples,
+    dump_refs,
+    font_stats,
+    measure,
+    layout,
+    capture,
+    start_capture,
+    stop_capture,
+    capture_stats,
     COMPILE_TIME_ENUM_SENTINEL
 };
 
@@ -282,6 +962,17 @@ enum class Namecall_Atom: int16_t {
     X(Lou_Mouse)\
     X(Lou_Create_Texture)\
     X(Lou_Callback_Handle)\
+    X(Lou_Math)\
+    X(Lou_Trace)\
+    X(Lou_Entities)\
+    X(Lou_Particles)\
+    X(Lou_Emitter)\
+    X(Lou_Tilemap)\
+    X(Lou_Spatial_Hash)\
+    X(Lou_Actors)\
+    X(Lou_Actor)\
+    X(Lou_Jobs)\
+    X(Lou_Profiler)\
     X(COMPILE_TIME_ENUM_SENTINEL)
 
 enum class Tag {
@@ -315,6 +1006,17 @@ Map_Type_To_Tag(Lou_Texture, Lou_Texture);
 Map_Type_To_Tag(Lou_Font, Lou_Font);
 Map_Type_To_Tag(Lou_Create_Texture, Lou_Create_Texture);
 Map_Type_To_Tag(Lou_Callback_Handle, Lou_Callback_Handle);
+Map_Type_To_Tag(Lou_Math, Lou_Math);
+Map_Type_To_Tag(Lou_Trace, Lou_Trace);
+Map_Type_To_Tag(Lou_Entities, Lou_Entities);
+Map_Type_To_Tag(Lou_Particles, Lou_Particles);
+Map_Type_To_Tag(Lou_Emitter, Lou_Emitter);
+Map_Type_To_Tag(Lou_Tilemap, Lou_Tilemap);
+Map_Type_To_Tag(Lou_Spatial_Hash, Lou_Spatial_Hash);
+Map_Type_To_Tag(Lou_Actors, Lou_Actors);
+Map_Type_To_Tag(Lou_Actor, Lou_Actor);
+Map_Type_To_Tag(Lou_Jobs, Lou_Jobs);
+Map_Type_To_Tag(Lou_Profiler, Lou_Profiler);
 
 #undef Map_Type_To_Tag
 
@@ -337,6 +1039,35 @@ concept Not_A_Pointer = not std::is_pointer_v<Ty>;
 template <class Ty>
 constexpr Tag Tag_For = detail::Mapped_Tag<Ty>::value;
 
+// lou and its subsystems live in Lou_State and are only ever reached through
+// a pointer. their userdata carry the value tag anyway, it is the only one
+// below the 32 types codegen can guard on, so typed parameters stay native.
+inline constexpr std::array handle_types{
+    Tag::Lou_State,
+    Tag::Lou_Console,
+    Tag::Lou_Keyboard,
+    Tag::Lou_Mouse,
+    Tag::Lou_Window,
+    Tag::Lou_Renderer,
+    Tag::Lou_Create_Texture,
+    Tag::Lou_Math,
+    Tag::Lou_Trace,
+    Tag::Lou_Entities,
+    Tag::Lou_Particles,
+    Tag::Lou_Actors,
+    Tag::Lou_Jobs,
+    Tag::Lou_Profiler,
+};
+template <Tag Val>
+constexpr bool is_handle_type = std::ranges::contains(handle_types, Val);
+// maps the tag of a value or reference userdata back to its Tag.
+constexpr auto from_userdata_tag(int tag) -> std::optional<Tag> {
+    constexpr int count = static_cast<int>(compile_time::count<Tag>());
+    if (tag >= 0 and tag < count) return static_cast<Tag>(tag);
+    const int referenced = LUA_UTAG_LIMIT - tag;
+    if (referenced > 0 and referenced < count) return static_cast<Tag>(referenced);
+    return std::nullopt;
+}
 inline auto vget_metatable_name(Tag tag) -> std::string {
     return std::string{compile_time::enum_item<Tag>(tag).name};
 };
@@ -361,6 +1092,7 @@ auto push_metatable(lua_State *L) -> decltype(auto) {
 template <Tag Val, class Ty = Type_For<Val>, class ...Ty_Args>
 requires std::constructible_from<Ty, Ty_Args...>
 auto make_tagged(lua_State* L, Ty_Args&&...args) -> Ty& {
+    static_assert(not is_handle_type<Val>, "handle types hold a pointer under their value tag");
     auto* p = static_cast<Ty*>(
         lua_newuserdatatagged(L, sizeof(Ty), static_cast<int>(Val))
     );
@@ -386,9 +1118,8 @@ auto push_tagged(lua_State *L, Ty& ref) -> void {
     if constexpr (As_Light_Userdata) {
         lua_pushlightuserdatatagged(L, &ref, int(Val));
     } else {
-        auto& p = *static_cast<Ty**>(
-            lua_newuserdatatagged(L, sizeof(Ty**), detail::tag_reference_cast<Val, int>())
-        );
+        constexpr int tag = is_handle_type<Val> ? static_cast<int>(Val) : detail::tag_reference_cast<Val, int>();
+        auto& p = *static_cast<Ty**>(lua_newuserdatatagged(L, sizeof(Ty**), tag));
         p = &ref;
         push_metatable<Val>(L);
         lua_setmetatable(L, -2);
@@ -418,7 +1149,9 @@ constexpr auto to_tagged_if(lua_State* L, int idx) -> Ty* {
     } else {
         const int tag = lua_userdatatag(L, idx);
         if (tag == static_cast<int>(Val)) {
-            return static_cast<Ty*>(lua_touserdatatagged(L, idx, static_cast<int>(Val)));
+            void* p = lua_touserdatatagged(L, idx, static_cast<int>(Val));
+            if constexpr (is_handle_type<Val>) return *static_cast<Ty**>(p);
+            else return static_cast<Ty*>(p);
         } else if (tag == detail::tag_reference_cast<Val, int>()) {
             return *static_cast<Ty**>(lua_touserdatatagged(L, idx, detail::tag_reference_cast<Val, int>()));
         }
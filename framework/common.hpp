@@ -5,14 +5,19 @@
 #include <format>
 #include <filesystem>
 #include <list>
+#include <map>
+#include <mutex>
 #include <fstream>
 #include <source_location>
 #include <string>
 #include <type_traits>
 #include <string_view>
 #include <array>
+#include <vector>
 #include <cassert>
 #include <ranges>
+#include "logger.hpp"
+#include "trace.hpp"
 
 inline auto stamp_time() -> std::string {
     using namespace std::chrono;
@@ -29,16 +34,33 @@ inline auto stamp_debug_info(const std::source_location& location = std::source_
     return std::format("[{:%T}]({}:{}): ", now, path(location.file_name()).filename().string(), location.line());
 }
 
-struct Logger {
-    std::ofstream file{"lou.log", std::ios::app};
-    template <class ...Ts>
-    auto log(const std::format_string<Ts...>& fmt, Ts&&...args) -> void {
-        file << stamp_debug_info();
-        file << std::format(fmt, std::forward<Ts>(args)...) << "\n";
-        file.flush();
+template <class Ty>
+class Ring_Buffer {
+    std::vector<Ty> items_;
+    size_t first_{};
+    size_t size_{};
+public:
+    explicit Ring_Buffer(size_t capacity): items_(capacity) {}
+    void push(Ty item) {
+        if (size_ < items_.size()) {
+            items_[(first_ + size_) % items_.size()] = std::move(item);
+            ++size_;
+        } else {
+            items_[first_] = std::move(item);
+            first_ = (first_ + 1) % items_.size();
+        }
+    }
+    auto operator[](size_t idx) -> Ty& {return items_[(first_ + idx) % items_.size()];}
+    auto operator[](size_t idx) const -> const Ty& {return items_[(first_ + idx) % items_.size()];}
+    auto size() const -> size_t {return size_;}
+    auto capacity() const -> size_t {return items_.size();}
+    auto empty() const -> bool {return size_ == 0;}
+    void clear() {
+        first_ = 0;
+        size_ = 0;
     }
 };
-inline Logger logger{};
+
 
 // compile time utility
 namespace compile_time {
@@ -176,59 +198,125 @@ constexpr Enum_Item<Type> enum_item(auto value) {
 }
 // genenric lua utility
 namespace lua {
+// the state currently inside of lua_close on this thread, refs owned by
+// userdata must not touch the registry while it is being torn down.
+inline thread_local lua_State* closing_state{nullptr};
+// where a Ref came from, kept for every live one so handles nobody releases
+// can be traced back to the script line that registered them.
+struct Ref_Origin {
+    // userdata tag of the `self` the registering method was called on, or -1.
+    int tag{-1};
+    std::string site{"native"};
+};
+inline auto ref_origin(lua_State* L) -> Ref_Origin {
+    Ref_Origin origin{.tag = lua_userdatatag(L, 1)};
+    lua_Debug ar;
+    for (int level{}; lua_getinfo(L, level, "sl", &ar); ++level) {
+        if (ar.currentline <= 0) continue;
+        origin.site = std::format("{}:{}", ar.short_src, ar.currentline);
+        break;
+    }
+    return origin;
+}
+// actors create refs in their own vms on worker threads, hence the mutex.
+class Ref_Audit {
+    mutable std::mutex mutex_;
+    std::map<std::pair<lua_State*, int>, Ref_Origin> live_;
+public:
+    void track(lua_State* L, int ref, Ref_Origin origin) {
+        std::scoped_lock lock{mutex_};
+        live_.insert_or_assign({L, ref}, std::move(origin));
+    }
+    void untrack(lua_State* L, int ref) {
+        std::scoped_lock lock{mutex_};
+        live_.erase({L, ref});
+    }
+    auto origin(lua_State* L, int ref) const -> Ref_Origin {
+        std::scoped_lock lock{mutex_};
+        auto found = live_.find({L, ref});
+        return found == live_.end() ? Ref_Origin{} : found->second;
+    }
+    // drops everything belonging to a closed state.
+    void forget(lua_State* L) {
+        std::scoped_lock lock{mutex_};
+        std::erase_if(live_, [L](const auto& e) {return e.first.first == L;});
+    }
+    auto live(lua_State* L) const -> std::vector<std::pair<int, Ref_Origin>> {
+        std::scoped_lock lock{mutex_};
+        std::vector<std::pair<int, Ref_Origin>> refs;
+        for (const auto& [key, origin] : live_) {
+            if (key.first == L) refs.emplace_back(key.second, origin);
+        }
+        return refs;
+    }
+};
+inline Ref_Audit ref_audit;
+inline void close(lua_State* L) {
+    closing_state = L;
+    lua_close(L);
+    closing_state = nullptr;
+    ref_audit.forget(L);
+}
 class Ref {
     int ref_;
     lua_State* state_;
+    void track(Ref_Origin origin) {
+        if (ref_ != LUA_REFNIL) ref_audit.track(state_, ref_, std::move(origin));
+    }
 public:
     Ref(): ref_(-1), state_(nullptr) {}
     Ref(lua_State* L, int idx):
         ref_(lua_ref(L, idx)),
         state_(lua_mainthread(L)) {
+        track(ref_origin(L));
     }
-    Ref(const Ref& other) {
-        state_ = other.state_;
+    Ref(const Ref& other): ref_(-1), state_(other.state_) {
         if (state_) {
-            push(state_);
+            other.push(state_);
             ref_ = lua_ref(state_, -1);
             lua_pop(state_, 1);
+            track(ref_audit.origin(state_, other.ref_));
         }
     }
-    Ref(Ref&& other) noexcept {
-        state_ = other.state_;
-        ref_ = other.ref_;
-        other.state_ = nullptr;
+    Ref(Ref&& other) noexcept:
+        ref_(other.ref_),
+        state_(std::exchange(other.state_, nullptr)) {
     }
     Ref& operator=(const Ref& other) {
-        state_ = other.state_;
-        if (state_) {
-            push(state_);
-            ref_ = lua_ref(state_, -1);
-            lua_pop(state_, 1);
-        }
+        if (this != &other) *this = Ref{other};
         return *this;
     }
     Ref& operator=(Ref&& other) noexcept {
-        state_ = other.state_;
-        ref_ = other.ref_;
-        other.state_ = nullptr;
+        if (this != &other) {
+            reset();
+            ref_ = other.ref_;
+            state_ = std::exchange(other.state_, nullptr);
+        }
         return *this;
     }
     ~Ref() {
-        if (state_) {
-            lua_unref(state_, ref_);
-        }
+        reset();
     }
     operator bool() const {
         return state_;
     }
-    void push(lua_State* L) {
+    void push(lua_State* L) const {
         if (not state_) {
             lua_pushnil(L);
             return;
         }
         lua_getref(L, ref_);
     }
+    // unpins the value, the ref is empty afterwards.
+    void reset() {
+        if (state_ and state_ != closing_state) {
+            lua_unref(state_, ref_);
+            if (ref_ != LUA_REFNIL) ref_audit.untrack(state_, ref_);
+        }
+        state_ = nullptr;
+    }
     void release() {
+        if (state_ and ref_ != LUA_REFNIL) ref_audit.untrack(state_, ref_);
         state_ = nullptr;
     }
 };
@@ -239,6 +327,15 @@ auto namecall_atom(lua_State* L) -> std::pair<As, std::string_view> {
     auto namecall = lua_namecallatom(L, &atom);
     return {static_cast<As>(atom), namecall};
 }
+// string atoms are assigned once when the string is created, which makes
+// this a cheap replacement for comparing keys in __index and __newindex.
+template <class As = int>
+auto index_atom(lua_State* L, int idx) -> std::pair<As, std::string_view> {
+    int atom{-1};
+    const char* key = lua_tostringatom(L, idx, &atom);
+    if (not key) luaL_typeerrorL(L, idx, "string");
+    return {static_cast<As>(atom), key};
+}
 template <class ...Tys>
 [[noreturn]] constexpr void error(lua_State* L, const std::format_string<Tys...>& fmt, Tys&&...args) {
     luaL_errorL(L, std::format(fmt, std::forward<Tys>(args)...).c_str());
@@ -459,6 +556,14 @@ concept Callback_List_Add_Compatible = requires (lua_State* L) {
     push(L, Ty{});
 } or std::is_void_v<Ty>;
 
+// resolves a 'source:line' name for the function at idx, only meant to be
+// called while tracing is enabled.
+inline auto trace_name(lua_State* L, int idx) -> const char* {
+    lua_Debug ar;
+    if (not lua_getinfo(L, idx, "s", &ar)) return "callback";
+    return tracing::intern(std::format("{}:{}", ar.short_src, ar.linedefined));
+}
+
 struct Basic_Callback_List {
     std::list<Ref> handlers;
     using Id = decltype(handlers)::iterator;
@@ -485,6 +590,7 @@ struct Callback_List {
         auto push_arg = [&L](auto arg) {push(L, std::forward<decltype(arg)>(arg));};
         for (auto& fn : callbacks.handlers) {
             fn.push(L);
+            tracing::Scope scope{tracing::enabled() ? trace_name(L, -1) : nullptr};
             (push_arg(std::forward<Args>(args)),...);
             if (lua_pcall(L, sizeof...(Args), 0, 0) != LUA_OK) {
                 console.error(lua_tostring(L, 1));
@@ -507,6 +613,7 @@ struct Callback_List<void> {
     auto call(lua_State* L, Console_Like& console) {
         for (auto& fn : callbacks.handlers) {
             fn.push(L);
+            tracing::Scope scope{tracing::enabled() ? trace_name(L, -1) : nullptr};
             if (lua_pcall(L, 0, 0, 0) != LUA_OK) {
                 console.error(lua_tostring(L, -1));
                 lua_pop(L, 1);
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace concurrent {
+// intrusive multi-producer single-consumer queue (Vyukov).
+// push is wait-free and may be called from any thread,
+// pop must only ever be called from the one consuming thread.
+template <class Ty>
+class Mpsc_Queue {
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        std::optional<Ty> value;
+    };
+    std::atomic<Node*> head_;
+    Node* tail_;
+public:
+    Mpsc_Queue(): head_(new Node{}), tail_(head_.load(std::memory_order_relaxed)) {}
+    Mpsc_Queue(const Mpsc_Queue&) = delete;
+    Mpsc_Queue& operator=(const Mpsc_Queue&) = delete;
+    ~Mpsc_Queue() {
+        while (pop()) {}
+        delete tail_;
+    }
+    template <class ...Ty_Args>
+    void push(Ty_Args&&...args) {
+        auto node = new Node{};
+        node->value.emplace(std::forward<Ty_Args>(args)...);
+        Node* previous = head_.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+    auto pop() -> std::optional<Ty> {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (not next) return std::nullopt;
+        tail_ = next;
+        std::optional<Ty> value{std::move(next->value)};
+        next->value.reset();
+        delete tail;
+        return value;
+    }
+    auto empty() const -> bool {
+        return tail_->next.load(std::memory_order_acquire) == nullptr;
+    }
+};
+}
@@ -0,0 +1,159 @@
+#include "jobs.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace jobs {
+namespace {
+struct Task {
+    Range_Fn fn;
+    void* context;
+    size_t begin;
+    size_t end;
+    std::atomic<size_t>* remaining;
+};
+struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+class Pool {
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    // tasks pushed but not taken yet, idle workers sleep while it's 0
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> next_queue_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stopping_{false};
+
+    auto pop_back(size_t index) -> std::optional<Task> {
+        auto& queue = *queues_[index];
+        std::scoped_lock lock{queue.mutex};
+        if (queue.tasks.empty()) return std::nullopt;
+        Task task = queue.tasks.back();
+        queue.tasks.pop_back();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    }
+    auto steal(size_t index) -> std::optional<Task> {
+        auto& queue = *queues_[index];
+        std::scoped_lock lock{queue.mutex};
+        if (queue.tasks.empty()) return std::nullopt;
+        Task task = queue.tasks.front();
+        queue.tasks.pop_front();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    }
+    auto steal_any(size_t first) -> std::optional<Task> {
+        for (size_t i{}; i < queues_.size(); ++i) {
+            if (auto task = steal((first + i) % queues_.size())) return task;
+        }
+        return std::nullopt;
+    }
+    static auto execute(const Task& task) -> void {
+        LOU_TRACE_SCOPE("job");
+        task.fn(task.context, task.begin, task.end);
+        task.remaining->fetch_sub(1, std::memory_order_release);
+    }
+    auto work(size_t index) -> void {
+        tracing::set_thread_name(std::format("job worker {}", index + 1));
+        while (true) {
+            auto task = pop_back(index);
+            if (not task) task = steal_any(index + 1);
+            if (task) {
+                execute(*task);
+                continue;
+            }
+            std::unique_lock lock{sleep_mutex_};
+            wake_.wait(lock, [this] {
+                return stopping_ or queued_.load(std::memory_order_relaxed) > 0;
+            });
+            if (stopping_) return;
+        }
+    }
+public:
+    explicit Pool(size_t worker_count) {
+        for (size_t i{}; i < worker_count; ++i) queues_.push_back(std::make_unique<Queue>());
+        for (size_t i{}; i < worker_count; ++i) workers_.emplace_back([this, i] {work(i);});
+    }
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+    ~Pool() {
+        {
+            std::scoped_lock lock{sleep_mutex_};
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+    auto thread_count() const -> size_t {
+        return workers_.size() + 1;
+    }
+    auto run(Range_Fn fn, void* context, size_t count, size_t grain) -> void {
+        // a few chunks per thread leave room for stealing when they're uneven
+        const size_t chunks = std::clamp<size_t>(count / grain, 1, thread_count() * 4);
+        const size_t chunk_size = (count + chunks - 1) / chunks;
+        std::atomic<size_t> remaining{0};
+        size_t queue = next_queue_.fetch_add(1, std::memory_order_relaxed);
+        for (size_t begin{}; begin < count; begin += chunk_size) {
+            const Task task{fn, context, begin, std::min(begin + chunk_size, count), &remaining};
+            remaining.fetch_add(1, std::memory_order_relaxed);
+            auto& target = *queues_[queue++ % queues_.size()];
+            std::scoped_lock lock{target.mutex};
+            target.tasks.push_back(task);
+            queued_.fetch_add(1, std::memory_order_relaxed);
+        }
+        {
+            std::scoped_lock lock{sleep_mutex_};
+        }
+        wake_.notify_all();
+        // the caller helps out instead of blocking, which is also what keeps
+        // a parallel_for running on a worker from starving the pool.
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (auto task = steal_any(queue)) {
+                execute(*task);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
+auto default_thread_count() -> size_t {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+auto pool() -> std::unique_ptr<Pool>& {
+    static auto instance = std::make_unique<Pool>(default_thread_count() - 1);
+    return instance;
+}
+}
+
+auto thread_count() -> size_t {
+    return pool()->thread_count();
+}
+
+auto set_thread_count(size_t count) -> void {
+    if (count == 0) count = default_thread_count();
+    auto& instance = pool();
+    if (instance->thread_count() == count) return;
+    instance.reset();
+    instance = std::make_unique<Pool>(count - 1);
+}
+
+auto run(Range_Fn fn, void* context, size_t count, size_t grain) -> void {
+    LOU_TRACE_SCOPE("parallel for");
+    auto& instance = *pool();
+    if (instance.thread_count() == 1) {
+        fn(context, 0, count);
+        return;
+    }
+    instance.run(fn, context, count, std::max<size_t>(grain, 1));
+}
+}
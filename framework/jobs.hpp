@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+
+// Work stealing thread pool shared by the native subsystems.
+// Every worker owns a deque, it pops its own tasks from the back and steals
+// from the front of the others once it runs dry. The thread calling
+// parallel_for works on the range too, so nested calls can't deadlock.
+namespace jobs {
+using Range_Fn = void(*)(void* context, size_t begin, size_t end);
+// threads working on a parallel_for, including the calling thread.
+auto thread_count() -> size_t;
+// 0 picks the hardware concurrency, 1 runs everything on the calling thread.
+// must not be called while a parallel_for is in flight.
+auto set_thread_count(size_t count) -> void;
+auto run(Range_Fn fn, void* context, size_t count, size_t grain) -> void;
+
+// calls `fn(begin, end)` for chunks of at least `grain` items covering
+// [0, count) and returns once all of them are done.
+template <class Fn>
+requires std::is_invocable_v<Fn&, size_t, size_t>
+auto parallel_for(size_t count, size_t grain, Fn&& fn) -> void {
+    if (count == 0) return;
+    if (count <= grain or thread_count() == 1) {
+        fn(size_t{0}, count);
+        return;
+    }
+    auto invoke = [](void* context, size_t begin, size_t end) {
+        (*static_cast<std::remove_reference_t<Fn>*>(context))(begin, end);
+    };
+    run(invoke, const_cast<void*>(static_cast<const void*>(&fn)), count, grain);
+}
+}
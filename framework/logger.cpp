@@ -0,0 +1,102 @@
+#include "logger.hpp"
+#include <filesystem>
+#include <fstream>
+namespace fs = std::filesystem;
+
+namespace {
+// hands the channel back to the logger once the owning thread exits.
+struct Channel_Lease {
+    const void* owner{nullptr};
+    std::atomic<bool>* in_use{nullptr};
+    void* channel{nullptr};
+    ~Channel_Lease() {
+        if (in_use) in_use->store(false, std::memory_order_release);
+    }
+};
+thread_local Channel_Lease lease;
+
+constexpr auto level_name(Log_Level level) -> std::string_view {
+    switch (level) {
+        case Log_Level::Debug: return "debug";
+        case Log_Level::Info: return "info";
+        case Log_Level::Warning: return "warning";
+        case Log_Level::Error: return "error";
+        default: return "";
+    }
+}
+}
+
+Logger::Logger(std::string path):
+    path_(std::move(path)),
+    writer_([this](std::stop_token stop) {write_loop(stop);}) {
+}
+
+Logger::~Logger() {
+    writer_.request_stop();
+    wake_.notify_all();
+    if (writer_.joinable()) writer_.join();
+}
+
+auto Logger::acquire_channel() -> Channel& {
+    if (lease.owner == this) return *static_cast<Channel*>(lease.channel);
+    std::scoped_lock lock{channels_mutex_};
+    Channel* found{nullptr};
+    for (auto& channel : channels_) {
+        bool expected{false};
+        if (channel->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            found = channel.get();
+            break;
+        }
+    }
+    if (not found) found = channels_.emplace_back(std::make_unique<Channel>()).get();
+    lease.owner = this;
+    lease.in_use = &found->in_use;
+    lease.channel = found;
+    return *found;
+}
+
+auto Logger::drain(std::string& batch) -> void {
+    using namespace std::chrono;
+    std::scoped_lock lock{channels_mutex_};
+    for (auto& channel : channels_) {
+        const size_t tail = channel->tail.load(std::memory_order_relaxed);
+        const size_t head = channel->head.load(std::memory_order_acquire);
+        for (size_t i = tail; i != head; ++i) {
+            const auto& record = channel->records[i % channel_capacity];
+            std::format_to(
+                std::back_inserter(batch),
+                "[{:%T}]({}:{}) {}: {}\n",
+                time_point_cast<duration<long long, std::centi>>(record.time),
+                fs::path(record.file).filename().string(),
+                record.line,
+                level_name(record.level),
+                std::string_view{record.text.data(), record.length}
+            );
+        }
+        channel->tail.store(head, std::memory_order_release);
+    }
+    const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reported_dropped_) {
+        std::format_to(std::back_inserter(batch), "dropped {} messages\n", dropped - reported_dropped_);
+        reported_dropped_ = dropped;
+    }
+}
+
+auto Logger::write_loop(std::stop_token stop) -> void {
+    std::ofstream file{path_, std::ios::app};
+    std::string batch;
+    while (not stop.stop_requested()) {
+        {
+            std::unique_lock lock{wake_mutex_};
+            wake_.wait_for(lock, stop, flush_interval, [] {return false;});
+        }
+        batch.clear();
+        drain(batch);
+        if (batch.empty()) continue;
+        file << batch;
+        file.flush();
+    }
+    batch.clear();
+    drain(batch);
+    file << batch;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// messages below this level are compiled out entirely.
+#ifndef LOU_LOG_LEVEL
+#ifdef NDEBUG
+#define LOU_LOG_LEVEL 1
+#else
+#define LOU_LOG_LEVEL 0
+#endif
+#endif
+
+enum class Log_Level: uint8_t {
+    Debug, Info, Warning, Error, Off
+};
+constexpr auto compile_time_log_level = static_cast<Log_Level>(LOU_LOG_LEVEL);
+
+template <class ...Ts>
+struct Log_Format {
+    std::format_string<Ts...> fmt;
+    std::source_location location;
+    template <class Ty>
+    requires std::convertible_to<const Ty&, std::string_view>
+    consteval Log_Format(const Ty& str, std::source_location location = std::source_location::current()):
+        fmt(str),
+        location(location) {
+    }
+};
+
+// Every logging thread gets its own single-producer ring of fixed size
+// records, a background thread drains them in batches. When a ring is full
+// the message gets dropped and counted instead of blocking the caller.
+class Logger {
+public:
+    static constexpr size_t message_capacity = 240;
+    static constexpr size_t channel_capacity = 512;
+    static constexpr auto flush_interval = std::chrono::milliseconds{50};
+    struct Record {
+        Log_Level level;
+        uint16_t length;
+        uint32_t line;
+        const char* file;
+        std::chrono::system_clock::time_point time;
+        std::array<char, message_capacity> text;
+    };
+private:
+    struct Channel {
+        std::array<Record, channel_capacity> records;
+        std::atomic<size_t> head{0};
+        std::atomic<size_t> tail{0};
+        std::atomic<bool> in_use{true};
+    };
+    std::mutex channels_mutex_;
+    std::vector<std::unique_ptr<Channel>> channels_;
+    std::atomic<Log_Level> level_{compile_time_log_level};
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t reported_dropped_{0};
+    std::string path_;
+    std::mutex wake_mutex_;
+    std::condition_variable_any wake_;
+    std::jthread writer_;
+    auto acquire_channel() -> Channel&;
+    auto drain(std::string& batch) -> void;
+    auto write_loop(std::stop_token stop) -> void;
+public:
+    explicit Logger(std::string path = "lou.log");
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+    ~Logger();
+    template <Log_Level Level, class ...Ts>
+    auto log(const Log_Format<std::type_identity_t<Ts>...>& fmt, Ts&&...args) -> void {
+        if constexpr (Level >= compile_time_log_level and Level != Log_Level::Off) {
+            if (Level < level_.load(std::memory_order_relaxed)) return;
+            auto& channel = acquire_channel();
+            const size_t head = channel.head.load(std::memory_order_relaxed);
+            if (head - channel.tail.load(std::memory_order_acquire) >= channel_capacity) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            auto& record = channel.records[head % channel_capacity];
+            auto result = std::format_to_n(record.text.data(), message_capacity, fmt.fmt, std::forward<Ts>(args)...);
+            record.length = static_cast<uint16_t>(std::min<size_t>(result.size, message_capacity));
+            record.level = Level;
+            record.file = fmt.location.file_name();
+            record.line = fmt.location.line();
+            record.time = std::chrono::system_clock::now();
+            channel.head.store(head + 1, std::memory_order_release);
+        }
+    }
+    template <class ...Ts>
+    auto debug(const Log_Format<std::type_identity_t<Ts>...>& fmt, Ts&&...args) -> void {
+        log<Log_Level::Debug, Ts...>(fmt, std::forward<Ts>(args)...);
+    }
+    template <class ...Ts>
+    auto info(const Log_Format<std::type_identity_t<Ts>...>& fmt, Ts&&...args) -> void {
+        log<Log_Level::Info, Ts...>(fmt, std::forward<Ts>(args)...);
+    }
+    template <class ...Ts>
+    auto warn(const Log_Format<std::type_identity_t<Ts>...>& fmt, Ts&&...args) -> void {
+        log<Log_Level::Warning, Ts...>(fmt, std::forward<Ts>(args)...);
+    }
+    template <class ...Ts>
+    auto error(const Log_Format<std::type_identity_t<Ts>...>& fmt, Ts&&...args) -> void {
+        log<Log_Level::Error, Ts...>(fmt, std::forward<Ts>(args)...);
+    }
+    auto set_level(Log_Level level) -> void {level_.store(level, std::memory_order_relaxed);}
+    auto level() const -> Log_Level {return level_.load(std::memory_order_relaxed);}
+    auto dropped() const -> uint64_t {return dropped_.load(std::memory_order_relaxed);}
+};
+inline Logger logger{};
@@ -0,0 +1,286 @@
+#include "Lou.hpp"
+#include <cstring>
+namespace fs = std::filesystem;
+namespace rngs = std::ranges;
+
+// a message is a sequence of values, each one a type byte followed by its
+// payload. tables are their key value pairs terminated by Value_Type::End.
+enum class Value_Type: uint8_t {
+    Nil, False, True, Number, String, Vector, Buffer, Table, End
+};
+// also what keeps cyclic tables from being serialized forever
+static constexpr int max_table_depth = 32;
+
+template <class Ty>
+static void put(std::string& out, const Ty& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(Ty));
+}
+template <class Ty>
+static auto take(std::string_view& in) -> Ty {
+    Ty value;
+    std::memcpy(&value, in.data(), sizeof(Ty));
+    in.remove_prefix(sizeof(Ty));
+    return value;
+}
+static void put_bytes(std::string& out, Value_Type type, const void* data, size_t size) {
+    put(out, type);
+    put(out, static_cast<uint32_t>(size));
+    out.append(static_cast<const char*>(data), size);
+}
+
+static auto serialize_value(lua_State* L, int idx, std::string& out, int depth) -> std::expected<void, std::string> {
+    switch (lua_type(L, idx)) {
+        case LUA_TNIL:
+            put(out, Value_Type::Nil);
+            return {};
+        case LUA_TBOOLEAN:
+            put(out, lua_toboolean(L, idx) ? Value_Type::True : Value_Type::False);
+            return {};
+        case LUA_TNUMBER:
+            put(out, Value_Type::Number);
+            put(out, lua_tonumber(L, idx));
+            return {};
+        case LUA_TSTRING: {
+            size_t size;
+            const char* data = lua_tolstring(L, idx, &size);
+            put_bytes(out, Value_Type::String, data, size);
+            return {};
+        }
+        case LUA_TVECTOR: {
+            put(out, Value_Type::Vector);
+            const float* v = lua_tovector(L, idx);
+            out.append(reinterpret_cast<const char*>(v), sizeof(float) * LUA_VECTOR_SIZE);
+            return {};
+        }
+        case LUA_TBUFFER: {
+            size_t size;
+            const void* data = lua_tobuffer(L, idx, &size);
+            put_bytes(out, Value_Type::Buffer, data, size);
+            return {};
+        }
+        case LUA_TTABLE: {
+            if (depth == max_table_depth) {
+                return std::unexpected(std::format("tables nested deeper than {} can't be sent", max_table_depth));
+            }
+            if (not lua_checkstack(L, 2)) return std::unexpected("stack overflow while serializing");
+            put(out, Value_Type::Table);
+            lua_pushnil(L);
+            while (lua_next(L, idx)) {
+                auto key = serialize_value(L, lua_absindex(L, -2), out, depth + 1);
+                auto value = key ? serialize_value(L, lua_absindex(L, -1), out, depth + 1) : key;
+                if (not value) {
+                    lua_pop(L, 2);
+                    return value;
+                }
+                lua_pop(L, 1);
+            }
+            put(out, Value_Type::End);
+            return {};
+        }
+        default:
+            return std::unexpected(std::format("{} values can't be sent", luaL_typename(L, idx)));
+    }
+}
+
+static auto deserialize_value(lua_State* L, std::string_view& in) -> void {
+    luaL_checkstack(L, 3, "message is nested too deep");
+    switch (take<Value_Type>(in)) {
+        case Value_Type::Nil:
+            lua_pushnil(L);
+            return;
+        case Value_Type::False:
+            lua_pushboolean(L, false);
+            return;
+        case Value_Type::True:
+            lua_pushboolean(L, true);
+            return;
+        case Value_Type::Number:
+            lua_pushnumber(L, take<double>(in));
+            return;
+        case Value_Type::String: {
+            const auto size = take<uint32_t>(in);
+            lua_pushlstring(L, in.data(), size);
+            in.remove_prefix(size);
+            return;
+        }
+        case Value_Type::Vector: {
+            auto v = take<std::array<float, LUA_VECTOR_SIZE>>(in);
+            lua_pushvector(L, v[0], v[1], v[2], v[3]);
+            return;
+        }
+        case Value_Type::Buffer: {
+            const auto size = take<uint32_t>(in);
+            std::memcpy(lua_newbuffer(L, size), in.data(), size);
+            in.remove_prefix(size);
+            return;
+        }
+        case Value_Type::Table:
+            lua_newtable(L);
+            while (static_cast<Value_Type>(in.front()) != Value_Type::End) {
+                deserialize_value(L, in);
+                deserialize_value(L, in);
+                lua_rawset(L, -3);
+            }
+            in.remove_prefix(1);
+            return;
+        case Value_Type::End:
+            break;
+    }
+    lua::error(L, "malformed message");
+}
+
+auto Lou_Actor::serialize(lua_State* L, int first) -> std::expected<Message, std::string> {
+    Message message;
+    for (int i{first}; i <= lua_gettop(L); ++i) {
+        auto serialized = serialize_value(L, i, message, 0);
+        if (not serialized) return std::unexpected(serialized.error());
+    }
+    return message;
+}
+
+auto Lou_Actor::deserialize(lua_State* L, std::string_view message) -> int {
+    int count{};
+    while (not message.empty()) {
+        deserialize_value(L, message);
+        ++count;
+    }
+    return count;
+}
+
+Lou_Actor::Lou_Actor(fs::path script, Lou_Console& console):
+    script(std::move(script)),
+    console(&console),
+    worker([this] {run();}) {
+}
+
+Lou_Actor::~Lou_Actor() {
+    stop();
+    if (worker.joinable()) worker.join();
+}
+
+auto Lou_Actor::send(Message message) -> void {
+    {
+        std::lock_guard lock{inbox.mutex};
+        if (stopping) return;
+        inbox.messages.push_back(std::move(message));
+    }
+    inbox.ready.notify_one();
+}
+
+auto Lou_Actor::stop() -> void {
+    {
+        std::lock_guard lock{inbox.mutex};
+        stopping = true;
+    }
+    inbox.ready.notify_one();
+}
+
+static auto load_actor_script(lua_State* L, const fs::path& path) -> std::expected<void, std::string> {
+    std::ifstream file{path};
+    if (not file.is_open()) return std::unexpected(std::format("failed to open '{}'", path.string()));
+    std::string line, contents;
+    while (std::getline(file, line)) contents.append(line + '\n');
+    auto bytecode = Luau::compile(contents, copts());
+    auto chunkname = std::format("@{}:", fs::absolute(path).string());
+    rngs::replace(chunkname, '\\', '/');
+    if (luau_load(L, chunkname.c_str(), bytecode.data(), bytecode.size(), 0) != LUA_OK) {
+        std::string load_error{lua_tostring(L, -1)};
+        lua_pop(L, 1);
+        return std::unexpected(std::move(load_error));
+    }
+    compile_native(L, -1);
+    if (lua_pcall(L, 0, 1, 0) != LUA_OK) {
+        std::string runtime_error{lua_tostring(L, -1)};
+        lua_pop(L, 1);
+        return std::unexpected(std::move(runtime_error));
+    }
+    if (not lua_isfunction(L, -1)) {
+        lua_pop(L, 1);
+        return std::unexpected("actor scripts must return a message handler");
+    }
+    return {};
+}
+
+// runs on the worker thread, the vm is created, used and closed only here.
+auto Lou_Actor::run() -> void {
+    auto post = [](lua_State* L) -> int {
+        auto& self = *static_cast<Lou_Actor*>(lua_callbacks(L)->userdata);
+        auto message = serialize(L, 1);
+        if (not message) lua::error(L, message.error());
+        self.outbox.push(std::move(*message));
+        return 0;
+    };
+    const luaL_Reg globals[] = {
+        {"post", post},
+        {nullptr, nullptr}
+    };
+    auto state = new_worker_luau(*console, this, globals);
+    auto L = state.get();
+    // lets stop() break out of handlers that never return
+    lua_callbacks(L)->interrupt = [](lua_State* L, int gc) {
+        if (gc >= 0) return;
+        auto& self = *static_cast<Lou_Actor*>(lua_callbacks(L)->userdata);
+        if (self.stopping.load(std::memory_order_relaxed)) lua::error(L, "actor was stopped");
+    };
+    auto loaded = load_actor_script(L, script);
+    if (not loaded) {
+        console->error(std::format("actor '{}': {}", script.string(), loaded.error()));
+    } else {
+        const int handler = lua_gettop(L);
+        while (true) {
+            Message message;
+            {
+                std::unique_lock lock{inbox.mutex};
+                inbox.ready.wait(lock, [this] {
+                    return stopping or not inbox.messages.empty();
+                });
+                if (stopping) break;
+                message = std::move(inbox.messages.front());
+                inbox.messages.pop_front();
+            }
+            lua_pushvalue(L, handler);
+            const int count = deserialize(L, message);
+            if (lua_pcall(L, count, 0, 0) != LUA_OK) {
+                if (stopping.load(std::memory_order_relaxed)) break;
+                console->error(std::format("actor '{}': {}", script.string(), lua_tostring(L, -1)));
+                lua_pop(L, 1);
+            }
+        }
+    }
+    state.reset();
+    finished.store(true, std::memory_order_release);
+}
+
+auto Lou_Actors::update(lua_State* L, Lou_Console& console) -> void {
+    if (running.empty()) return;
+    LOU_TRACE_SCOPE("actors update");
+    // handlers may spawn actors, so the list is indexed instead of iterated
+    for (size_t i{}; i < running.size(); ++i) {
+        Lou_Actor* actor = running[i].actor;
+        while (auto message = actor->outbox.pop()) {
+            const int top = lua_gettop(L);
+            const int count = Lou_Actor::deserialize(L, *message);
+            luaL_checkstack(L, count + 1, "too many values in message");
+            for (auto& fn : actor->received.handlers) {
+                fn.push(L);
+                tracing::Scope scope{tracing::enabled() ? lua::trace_name(L, -1) : nullptr};
+                for (int value{1}; value <= count; ++value) lua_pushvalue(L, top + value);
+                if (lua_pcall(L, count, 0, 0) != LUA_OK) {
+                    console.error(lua_tostring(L, -1));
+                    lua_pop(L, 1);
+                }
+            }
+            lua_settop(L, top);
+        }
+    }
+    // finished actors are let go once everything they posted got delivered
+    for (size_t i{}; i < running.size();) {
+        auto actor = running[i].actor;
+        if (actor->finished.load(std::memory_order_acquire) and actor->outbox.empty()) {
+            std::swap(running[i], running.back());
+            running.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
@@ -0,0 +1,159 @@
+#include "Lou.hpp"
+namespace fs = std::filesystem;
+
+static auto write_raw(const SDL_Surface* surface, const fs::path& file) -> std::expected<void, std::string> {
+    std::ofstream out{file, std::ios::binary};
+    if (not out.is_open()) return std::unexpected(std::format("failed to open '{}'", file.string()));
+    const auto row = static_cast<std::streamsize>(surface->w) * SDL_BYTESPERPIXEL(surface->format);
+    const auto pixels = static_cast<const char*>(surface->pixels);
+    for (int y{}; y < surface->h; ++y) out.write(pixels + y * surface->pitch, row);
+    if (not out) return std::unexpected(std::format("failed to write '{}'", file.string()));
+    return {};
+}
+
+static auto encode(const Lou_Capture::Frame& frame) -> std::expected<void, std::string> {
+    if (frame.format == Lou_Capture::Format::Raw) return write_raw(frame.surface.get(), frame.file);
+    if (not IMG_SavePNG(frame.surface.get(), frame.file.string().c_str())) return std::unexpected(SDL_GetError());
+    return {};
+}
+
+Lou_Capture::~Lou_Capture() {
+    {
+        std::scoped_lock lock{queue.mutex};
+        queue.stopping = true;
+    }
+    queue.ready.notify_one();
+    if (worker.joinable()) worker.join();
+}
+
+auto Lou_Capture::request(fs::path file) -> void {
+    requested.push_back(std::move(file));
+}
+
+auto Lou_Capture::start(fs::path directory, Format format) -> std::expected<void, std::string> {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) return std::unexpected(std::format("failed to create '{}': {}", directory.string(), ec.message()));
+    continuous = {.active = true, .directory = std::move(directory), .format = format};
+    return {};
+}
+
+auto Lou_Capture::stop() -> void {
+    continuous.active = false;
+}
+
+auto Lou_Capture::stats() const -> Stats {
+    return {
+        .written = written.load(std::memory_order_relaxed),
+        .dropped = dropped.load(std::memory_order_relaxed),
+        .failed = failed.load(std::memory_order_relaxed),
+    };
+}
+
+auto Lou_Capture::pooled_surface(int width, int height) -> C_Owner_t<SDL_Surface> {
+    {
+        std::scoped_lock lock{queue.mutex};
+        // surfaces of an old window size are let go here
+        while (not queue.pool.empty()) {
+            auto surface = std::move(queue.pool.back());
+            queue.pool.pop_back();
+            if (surface->w == width and surface->h == height) return surface;
+        }
+    }
+    return {SDL_CreateSurface(width, height, SDL_PIXELFORMAT_RGBA32), SDL_DestroySurface};
+}
+
+auto Lou_Capture::read_frame(SDL_Renderer* renderer, Lou_Console& console) -> void {
+    if (failed.load(std::memory_order_relaxed) != reported_failures) {
+        std::scoped_lock lock{queue.mutex};
+        for (const auto& error : queue.errors) console.error(std::format("capture: {}", error));
+        queue.errors.clear();
+        reported_failures = failed.load(std::memory_order_relaxed);
+    }
+    if (requested.empty() and not continuous.active) return;
+    bool continuous_frame{false};
+    if (continuous.active) {
+        bool full;
+        {
+            std::scoped_lock lock{queue.mutex};
+            full = queue.frames.size() >= max_queued;
+        }
+        // dropped frames keep their number, so the gaps show in the files
+        if (full) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            continuous_frame = true;
+        }
+    }
+    if (requested.empty() and not continuous_frame) {
+        ++continuous.next_frame;
+        return;
+    }
+    LOU_TRACE_SCOPE("capture readback");
+    C_Owner_t<SDL_Surface> readback{SDL_RenderReadPixels(renderer, nullptr), SDL_DestroySurface};
+    if (not readback) {
+        console.error(std::format("capture: {}", SDL_GetError()));
+        requested.clear();
+        if (continuous_frame) ++continuous.next_frame;
+        return;
+    }
+    std::vector<std::pair<fs::path, Format>> targets;
+    for (auto& file : requested) {
+        const auto format = file.extension() == ".png" ? Format::Png : Format::Raw;
+        targets.emplace_back(std::move(file), format);
+    }
+    requested.clear();
+    if (continuous_frame) {
+        const auto name = continuous.format == Format::Png
+            ? std::format("frame_{:06}.png", continuous.next_frame)
+            : std::format("frame_{:06}_{}x{}.rgba", continuous.next_frame, readback->w, readback->h);
+        targets.emplace_back(continuous.directory / name, continuous.format);
+        ++continuous.next_frame;
+    }
+    for (auto& [file, format] : targets) {
+        auto surface = pooled_surface(readback->w, readback->h);
+        const bool converted = surface and SDL_ConvertPixels(
+            readback->w, readback->h,
+            readback->format, readback->pixels, readback->pitch,
+            surface->format, surface->pixels, surface->pitch
+        );
+        if (not converted) {
+            failed.fetch_add(1, std::memory_order_relaxed);
+            ++reported_failures;
+            console.error(std::format("capture: {}", SDL_GetError()));
+            continue;
+        }
+        {
+            std::scoped_lock lock{queue.mutex};
+            queue.frames.push_back({.surface = std::move(surface), .file = std::move(file), .format = format});
+        }
+        queue.ready.notify_one();
+    }
+    if (not worker.joinable()) worker = std::thread([this] {run();});
+}
+
+auto Lou_Capture::run() -> void {
+    tracing::set_thread_name("capture encoder");
+    while (true) {
+        Frame frame;
+        {
+            std::unique_lock lock{queue.mutex};
+            queue.ready.wait(lock, [this] {
+                return queue.stopping or not queue.frames.empty();
+            });
+            if (queue.frames.empty()) return;
+            frame = std::move(queue.frames.front());
+            queue.frames.pop_front();
+        }
+        LOU_TRACE_SCOPE("capture encode");
+        auto encoded = encode(frame);
+        std::scoped_lock lock{queue.mutex};
+        if (encoded) {
+            written.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            queue.errors.push_back(std::move(encoded.error()));
+            failed.fetch_add(1, std::memory_order_relaxed);
+        }
+        queue.pool.push_back(std::move(frame.surface));
+    }
+}
@@ -0,0 +1,142 @@
+#include "Lou.hpp"
+
+auto Lou_Entities::spawn(SDL_FPoint position, SDL_FPoint velocity, float lifetime) -> std::expected<Id, std::string> {
+    uint32_t slot;
+    if (not free_slots.empty()) {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        if (generation.size() > slot_mask) return std::unexpected("entity limit reached");
+        slot = static_cast<uint32_t>(generation.size());
+        generation.push_back(0);
+        dense_index.push_back(no_index);
+    }
+    const Id id = (generation[slot] << slot_bits) | slot;
+    dense_index[slot] = static_cast<uint32_t>(ids.size());
+    ids.push_back(id);
+    this->position.push_back(position);
+    this->velocity.push_back(velocity);
+    this->lifetime.push_back(lifetime);
+    sprite.emplace_back();
+    return id;
+}
+
+auto Lou_Entities::find(Id id) const -> std::optional<size_t> {
+    const uint32_t slot = id & slot_mask;
+    if (slot >= generation.size() or generation[slot] != id >> slot_bits) return std::nullopt;
+    const uint32_t index = dense_index[slot];
+    if (index == no_index) return std::nullopt;
+    return index;
+}
+
+auto Lou_Entities::remove(Id id) -> bool {
+    auto found = find(id);
+    if (not found) return false;
+    const size_t index = *found;
+    const size_t last = ids.size() - 1;
+    release_texture(sprite[index].texture);
+    if (index != last) {
+        ids[index] = ids[last];
+        position[index] = position[last];
+        velocity[index] = velocity[last];
+        sprite[index] = sprite[last];
+        lifetime[index] = lifetime[last];
+        dense_index[ids[index] & slot_mask] = static_cast<uint32_t>(index);
+    }
+    ids.pop_back();
+    position.pop_back();
+    velocity.pop_back();
+    sprite.pop_back();
+    lifetime.pop_back();
+    const uint32_t slot = id & slot_mask;
+    dense_index[slot] = no_index;
+    generation[slot] = (generation[slot] + 1) & generation_mask;
+    free_slots.push_back(slot);
+    return true;
+}
+
+auto Lou_Entities::set_sprite(lua_State* L, size_t index, int idx, SDL_FPoint size, float angle) -> void {
+    auto& texture = to_tagged<Tag::Lou_Texture>(L, idx);
+    auto& current = sprite[index];
+    if (current.texture != &texture) {
+        auto& use = textures[&texture];
+        if (not use.ref) use.ref = lua::Ref(L, idx);
+        ++use.users;
+        release_texture(current.texture);
+    }
+    current = {.texture = &texture, .size = size, .angle = angle};
+}
+
+auto Lou_Entities::release_texture(Lou_Texture* texture) -> void {
+    if (not texture) return;
+    auto found = textures.find(texture);
+    if (found == textures.end()) return;
+    if (--found->second.users == 0) textures.erase(found);
+}
+
+auto Lou_Entities::clear() -> void {
+    ids.clear();
+    position.clear();
+    velocity.clear();
+    sprite.clear();
+    lifetime.clear();
+    for (uint32_t slot{}; slot < generation.size(); ++slot) {
+        if (dense_index[slot] == no_index) continue;
+        dense_index[slot] = no_index;
+        generation[slot] = (generation[slot] + 1) & generation_mask;
+        free_slots.push_back(slot);
+    }
+    textures.clear();
+}
+
+auto Lou_Entities::update(lua_State* L, Lou_Console& console, double delta_seconds) -> void {
+    if (ids.empty()) return;
+    LOU_TRACE_SCOPE("entities update");
+    const auto dt = static_cast<float>(delta_seconds);
+    const size_t count = ids.size();
+    jobs::parallel_for(count, parallel_grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            position[i].x += velocity[i].x * dt;
+            position[i].y += velocity[i].y * dt;
+            lifetime[i] -= dt;
+        }
+    });
+    expired_ids.clear();
+    for (size_t i{}; i < count; ++i) {
+        if (lifetime[i] <= 0) expired_ids.push_back(ids[i]);
+    }
+    // handlers may spawn, remove or revive entities, so everything
+    // is looked up again by id rather than by dense index.
+    for (Id id : expired_ids) {
+        expired.call(L, console, static_cast<double>(id));
+        auto index = find(id);
+        if (index and lifetime[*index] <= 0) remove(id);
+    }
+}
+
+auto Lou_Entities::render(lua_State* L, Lou_Renderer& renderer, Lou_Console& console) -> void {
+    if (textures.empty()) return;
+    LOU_TRACE_SCOPE("entities render");
+    for (auto& [texture, use] : textures) {
+        auto drawn = texture->redraw_if_dirty(L);
+        if (not drawn) console.error(drawn.error());
+    }
+    for (size_t i{}; i < ids.size(); ++i) {
+        const auto& s = sprite[i];
+        if (not s.texture) continue;
+        const bool drawn = renderer.draw_sprite(*s.texture, {
+            .source = s.texture->source_rect(),
+            .destination = {
+                position[i].x - s.size.x / 2,
+                position[i].y - s.size.y / 2,
+                s.size.x,
+                s.size.y,
+            },
+            .angle = s.angle,
+        });
+        if (not drawn) {
+            console.error(SDL_GetError());
+            return;
+        }
+    }
+}
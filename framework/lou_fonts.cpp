@@ -0,0 +1,90 @@
+#include "Lou.hpp"
+namespace fs = std::filesystem;
+
+static auto read_file(const fs::path& file) -> std::expected<std::string, std::string> {
+    std::ifstream in{file, std::ios::binary};
+    if (not in.is_open()) return std::unexpected(std::format("failed to open '{}'", file.string()));
+    return std::string{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
+auto Lou_Fonts::open(const fs::path& file, float size) -> std::expected<std::shared_ptr<TTF_Font>, std::string> {
+    std::error_code ec;
+    auto resolved = fs::weakly_canonical(file, ec);
+    const auto path = (ec ? file : resolved).string();
+    auto& cached = fonts[{path, size}];
+    if (auto font = cached.lock()) return font;
+    LOU_TRACE_SCOPE("font open");
+    auto bytes = files[path].lock();
+    if (not bytes) {
+        auto read = read_file(path);
+        if (not read) return std::unexpected(read.error());
+        bytes = std::make_shared<const std::string>(std::move(*read));
+        files[path] = bytes;
+    }
+    auto io = SDL_IOFromConstMem(bytes->data(), bytes->size());
+    if (not io) return std::unexpected(SDL_GetError());
+    auto opened = TTF_OpenFontIO(io, true, size);
+    if (not opened) return std::unexpected(SDL_GetError());
+    // the font reads glyphs from the bytes lazily, so it keeps them alive
+    std::shared_ptr<TTF_Font> font{opened, [bytes](TTF_Font* font) {TTF_CloseFont(font);}};
+    cached = font;
+    return font;
+}
+
+static auto layout_hash(const TTF_Font* font, std::string_view text, int wrap_width) -> size_t {
+    size_t hash = std::hash<std::string_view>{}(text);
+    auto combine = [&hash](size_t value) {
+        hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    };
+    combine(std::hash<const void*>{}(font));
+    combine(std::hash<int>{}(wrap_width));
+    return hash;
+}
+
+auto Lou_Fonts::layout(TTF_TextEngine* engine, const std::shared_ptr<TTF_Font>& font, std::string_view text, int wrap_width) -> std::expected<Layout*, std::string> {
+    const size_t hash = layout_hash(font.get(), text, wrap_width);
+    auto [first, last] = layout_index.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        auto cached = it->second;
+        if (cached->font != font or cached->wrap_width != wrap_width or cached->text != text) continue;
+        layouts.splice(layouts.begin(), layouts, cached);
+        return &*cached;
+    }
+    LOU_TRACE_SCOPE("text layout");
+    C_Owner_t<TTF_Text> ptr{TTF_CreateText(engine, font.get(), text.data(), text.size()), TTF_DestroyText};
+    if (not ptr) return std::unexpected(SDL_GetError());
+    if (not TTF_SetTextWrapWidth(ptr.get(), wrap_width)) return std::unexpected(SDL_GetError());
+    int width, height;
+    if (not TTF_GetTextSize(ptr.get(), &width, &height)) return std::unexpected(SDL_GetError());
+    if (layouts.size() == layout_capacity) {
+        auto oldest = std::prev(layouts.end());
+        auto [begin, end] = layout_index.equal_range(oldest->hash);
+        for (auto it = begin; it != end; ++it) {
+            if (it->second != oldest) continue;
+            layout_index.erase(it);
+            break;
+        }
+        layouts.pop_back();
+    }
+    layouts.push_front(Layout{
+        .font = font,
+        .text = std::string{text},
+        .wrap_width = wrap_width,
+        .hash = hash,
+        .ptr = std::move(ptr),
+        .width = width,
+        .height = height,
+    });
+    layout_index.emplace(hash, layouts.begin());
+    return &layouts.front();
+}
+
+auto Lou_Fonts::stats() -> Stats {
+    std::erase_if(fonts, [](const auto& e) {return e.second.expired();});
+    std::erase_if(files, [](const auto& e) {return e.second.expired();});
+    Stats stats{.files = files.size(), .fonts = fonts.size(), .file_bytes = 0};
+    for (const auto& [path, file] : files) {
+        if (auto bytes = file.lock()) stats.file_bytes += bytes->size();
+    }
+    return stats;
+}
@@ -1,8 +1,8 @@
 #include <imgui_impl_sdl3.h>
 #include <imgui_impl_sdlrenderer3.h>
-#include <SDL3/SDL_main.h>
 #include <SDL3_image/SDL_image.h>
 #include "Lou.hpp"
+#include <Luau/CodeGen.h>
 #include <imgui.h>
 #include <filesystem>
 #include <Luau/Compiler.h>
@@ -14,14 +14,19 @@ using Init_Info = Lou_State::Init_Info;
 static void init_window_and_renderer(Lou_State* state, const Init_Info& info) {
     SDL_Renderer* renderer{};
     SDL_Window* window{};
-    SDL_CreateWindowAndRenderer(
-        info.title.c_str(),
-        info.width,
-        info.height,
-        info.flags,
-        &window,
-        &renderer
-    );
+    if (info.render_driver.empty()) {
+        SDL_CreateWindowAndRenderer(
+            info.title.c_str(),
+            info.width,
+            info.height,
+            info.flags,
+            &window,
+            &renderer
+        );
+    } else {
+        window = SDL_CreateWindow(info.title.c_str(), info.width, info.height, info.flags);
+        if (window) renderer = SDL_CreateRenderer(window, info.render_driver.c_str());
+    }
     assert(window and renderer);
     state->window.owning.window.reset(window);
     state->renderer.owning.renderer.reset(renderer);
@@ -35,10 +40,15 @@ static auto run_script_entry_point(lua_State* L, const fs::path& script_entry_po
     }
     std::string line, contents;
     while (std::getline(file, line)) contents.append(line + '\n');
-    auto bytecode = Luau::compile(contents, {});
+    auto bytecode = Luau::compile(contents, copts());
     auto chunkname = std::format("@{}:", fs::absolute(path).string());
     rngs::replace(chunkname, '\\', '/');
-    auto status = luau_load(L, chunkname.c_str(), bytecode.data(), bytecode.size(), 0);
+    if (luau_load(L, chunkname.c_str(), bytecode.data(), bytecode.size(), 0) != LUA_OK) {
+        std::string load_error{lua_tostring(L, -1)};
+        lua_pop(L, 1);
+        return std::unexpected(std::move(load_error));
+    }
+    compile_native(L, -1);
     if (lua_pcall(L, 0, 0, 0) != LUA_OK) {
         std::string runtime_error{lua_tostring(L, -1)};
         lua_pop(L, 1);
@@ -47,10 +57,24 @@ static auto run_script_entry_point(lua_State* L, const fs::path& script_entry_po
     return {};
 }
 
+// recorded sessions need the same random sequence on every replay
+static void seed_random(lua_State* L, uint64_t seed) {
+    lua_getglobal(L, "math");
+    lua_getfield(L, -1, "randomseed");
+    lua_pushnumber(L, static_cast<double>(seed & ((1ull << 53) - 1)));
+    lua_call(L, 1, 0);
+    lua_pop(L, 1);
+}
+
 void Lou_State::init(Init_Info info) {
+    tracing::set_thread_name("main");
+    if (not info.video_driver.empty()) SDL_SetHint(SDL_HINT_VIDEO_DRIVER, info.video_driver.c_str());
     SDL_Init(SDL_INIT_VIDEO);
     TTF_Init();
     init_window_and_renderer(this, info);
+    frame.idle_mode = info.idle_mode;
+    fold_vector_constructors = info.fold_vector_constructors;
+    native_codegen = info.native_codegen and Luau::CodeGen::isSupported();
     ImGui::CreateContext();
     ImGui_ImplSDL3_InitForSDLRenderer(window.get(), renderer.get());
     ImGui_ImplSDLRenderer3_Init(renderer.get());
@@ -61,25 +85,41 @@ void Lou_State::init(Init_Info info) {
     renderer.owning.text_engine.reset(TTF_CreateRendererTextEngine(renderer.get()));
     texture.renderer = renderer.get();
     //auto font = TTF_OpenFont("resources/main.ttf", 60);
+    if (not info.record_file.empty()) {
+        auto recording = replay.start_recording(info.record_file);
+        if (not recording) console.error(recording.error());
+    } else if (not info.replay_file.empty()) {
+        auto replaying = replay.start_replay(info.replay_file, info.replay_delta);
+        if (not replaying) console.error(replaying.error());
+    }
+    frame.collect_work_ms = info.collect_frame_times or replay.mode != Lou_Replay::Mode::Off;
     init_luau();
+    if (replay.mode != Lou_Replay::Mode::Off) seed_random(lua_state(), replay.seed);
     auto ok = run_script_entry_point(lua_state(), info.script_entry_point);
     if (not ok) console.error(ok.error());
+    if (native_codegen) logger.info("userdata call sites with a typed result:\n{}", typed_results_report());
 }
 
 
-auto main(int argc, char** argv) -> int {
-    Lou_State state;
-    state.init({
-        .title{"test"},
-        .width = 1920,
-        .height = 1080,
-        .flags = SDL_WINDOW_RESIZABLE,
-        .script_entry_point = argc > 1 ? argv[1] : "init.luau",
-    });
-    while(state.running) {
-        state.update();
-        state.render();
-        SDL_Delay(16);
+Lou_State::~Lou_State() {
+    // callback refs have to be released while the vm is still alive and the
+    // vm has to go before the renderer, since userdata own SDL resources.
+    destroyed_callbacks.clear();
+    on_update.callbacks.handlers.clear();
+    on_render.callbacks.handlers.clear();
+    keyboard.pressed.callbacks.handlers.clear();
+    keyboard.released.callbacks.handlers.clear();
+    mouse.pressed.callbacks.handlers.clear();
+    mouse.released.callbacks.handlers.clear();
+    mouse.moved.callbacks.handlers.clear();
+    entities.expired.callbacks.handlers.clear();
+    entities.clear();
+    // collecting the actors joins their workers
+    actors.running.clear();
+    owning.luau.reset();
+    if (ImGui::GetCurrentContext()) {
+        ImGui_ImplSDLRenderer3_Shutdown();
+        ImGui_ImplSDL3_Shutdown();
+        ImGui::DestroyContext();
     }
-    return 0;
 }
@@ -0,0 +1,49 @@
+#include "Lou.hpp"
+
+template <class Fn>
+static auto for_each_element(std::span<float> data, size_t stride, Fn kernel) -> void {
+    const size_t count = data.size() / stride;
+    jobs::parallel_for(count, Lou_Jobs::grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) kernel(data.data() + i * stride);
+    });
+}
+static auto lane_count(size_t stride) -> size_t {
+    return std::min<size_t>(stride, LUA_VECTOR_SIZE);
+}
+
+auto Lou_Jobs::translate(std::span<float> data, size_t stride, Lanes_t offset) -> void {
+    const size_t lanes = lane_count(stride);
+    for_each_element(data, stride, [&](float* e) {
+        for (size_t lane{}; lane < lanes; ++lane) e[lane] += offset[lane];
+    });
+}
+
+auto Lou_Jobs::scale(std::span<float> data, size_t stride, Lanes_t factor) -> void {
+    const size_t lanes = lane_count(stride);
+    for_each_element(data, stride, [&](float* e) {
+        for (size_t lane{}; lane < lanes; ++lane) e[lane] *= factor[lane];
+    });
+}
+
+auto Lou_Jobs::clamp(std::span<float> data, size_t stride, Lanes_t min, Lanes_t max) -> void {
+    const size_t lanes = lane_count(stride);
+    for_each_element(data, stride, [&](float* e) {
+        for (size_t lane{}; lane < lanes; ++lane) e[lane] = std::clamp(e[lane], min[lane], max[lane]);
+    });
+}
+
+auto Lou_Jobs::integrate(std::span<float> data, size_t stride, float delta_seconds) -> void {
+    for_each_element(data, stride, [=](float* e) {
+        e[0] += e[2] * delta_seconds;
+        e[1] += e[3] * delta_seconds;
+    });
+}
+
+auto Lou_Jobs::transform(std::span<float> data, size_t stride, Lanes_t linear, SDL_FPoint offset) -> void {
+    for_each_element(data, stride, [&](float* e) {
+        const float x = e[0];
+        const float y = e[1];
+        e[0] = linear[0] * x + linear[1] * y + offset.x;
+        e[1] = linear[2] * x + linear[3] * y + offset.y;
+    });
+}
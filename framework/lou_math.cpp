@@ -0,0 +1,121 @@
+#include "Lou.hpp"
+#include <cmath>
+using Point_Matrix = blaze::CustomMatrix<float, blaze::unaligned, blaze::unpadded, blaze::columnMajor>;
+using Const_Point_Matrix = blaze::CustomMatrix<const float, blaze::unaligned, blaze::unpadded, blaze::columnMajor>;
+using Point = blaze::StaticVector<float, 2, blaze::columnVector>;
+
+// a column-major 2xN matrix maps exactly onto interleaved x, y pairs,
+// so the buffer contents can be handed to blaze without copying.
+static auto as_matrix(Lou_Math::Points_t points) -> Point_Matrix {
+    return Point_Matrix(points.data(), 2, points.size() / 2);
+}
+static auto as_matrix(std::span<const float> points) -> Const_Point_Matrix {
+    return Const_Point_Matrix(points.data(), 2, points.size() / 2);
+}
+
+// large point sets are split over the job system, the kernel is then
+// called again per chunk and runs those directly.
+static constexpr size_t parallel_threshold = 1 << 16;
+static constexpr size_t parallel_grain = 1 << 14;
+static thread_local bool in_chunk{false};
+template <class Kernel>
+static auto in_parallel(Lou_Math::Points_t points, Kernel kernel) -> bool {
+    const size_t count = points.size() / 2;
+    if (in_chunk or count < parallel_threshold or jobs::thread_count() == 1) return false;
+    jobs::parallel_for(count, parallel_grain, [&](size_t begin, size_t end) {
+        in_chunk = true;
+        kernel(points.subspan(begin * 2, (end - begin) * 2));
+        in_chunk = false;
+    });
+    return true;
+}
+
+auto Lou_Math::to_points(lua_State* L, int idx) -> Points_t {
+    size_t len{};
+    auto data = static_cast<float*>(luaL_checkbuffer(L, idx, &len));
+    const size_t count = len / (sizeof(float) * 2);
+    return {data, count * 2};
+}
+
+auto Lou_Math::transform(Points_t points, Vector_t linear, SDL_FPoint offset) -> void {
+    if (points.empty()) return;
+    if (in_parallel(points, [&](Points_t chunk) {transform(chunk, linear, offset);})) return;
+    auto matrix = as_matrix(points);
+    const blaze::StaticMatrix<float, 2, 2> m{
+        {linear[0], linear[1]},
+        {linear[2], linear[3]},
+    };
+    // the product aliases its operand, so it goes through a scratch
+    // matrix which only ever grows to avoid allocating every call.
+    thread_local blaze::DynamicMatrix<float, blaze::columnMajor> scratch;
+    scratch.resize(2, matrix.columns(), false);
+    scratch = m * matrix;
+    matrix = scratch + blaze::expand(Point{offset.x, offset.y}, matrix.columns());
+}
+
+auto Lou_Math::translate(Points_t points, SDL_FPoint offset) -> void {
+    if (points.empty()) return;
+    if (in_parallel(points, [&](Points_t chunk) {translate(chunk, offset);})) return;
+    auto matrix = as_matrix(points);
+    matrix += blaze::expand(Point{offset.x, offset.y}, matrix.columns());
+}
+
+auto Lou_Math::scale(Points_t points, SDL_FPoint factor, SDL_FPoint pivot) -> void {
+    if (points.empty()) return;
+    if (in_parallel(points, [&](Points_t chunk) {scale(chunk, factor, pivot);})) return;
+    auto matrix = as_matrix(points);
+    const Point f{factor.x, factor.y};
+    const Point shift{pivot.x - factor.x * pivot.x, pivot.y - factor.y * pivot.y};
+    matrix = blaze::expand(f, matrix.columns()) % matrix + blaze::expand(shift, matrix.columns());
+}
+
+auto Lou_Math::rotate(Points_t points, float radians, SDL_FPoint pivot) -> void {
+    const float c = std::cos(radians);
+    const float s = std::sin(radians);
+    const std::array linear{c, -s, s, c};
+    const SDL_FPoint offset{
+        pivot.x - (c * pivot.x - s * pivot.y),
+        pivot.y - (s * pivot.x + c * pivot.y),
+    };
+    transform(points, Vector_t{linear.data(), LUA_VECTOR_SIZE}, offset);
+}
+
+auto Lou_Math::bounds(std::span<const float> points) -> SDL_FRect {
+    if (points.empty()) return {0, 0, 0, 0};
+    auto matrix = as_matrix(points);
+    const float min_x = blaze::min(blaze::row(matrix, 0));
+    const float min_y = blaze::min(blaze::row(matrix, 1));
+    const float max_x = blaze::max(blaze::row(matrix, 0));
+    const float max_y = blaze::max(blaze::row(matrix, 1));
+    return {min_x, min_y, max_x - min_x, max_y - min_y};
+}
+
+auto Lou_Math::cull_points(std::span<const float> points, SDL_FRect view, Points_t out) -> size_t {
+    const float right = view.x + view.w;
+    const float bottom = view.y + view.h;
+    const size_t capacity = out.size() / 2;
+    size_t count{};
+    for (size_t i{}; i + 1 < points.size() and count < capacity; i += 2) {
+        const float x = points[i];
+        const float y = points[i + 1];
+        out[count * 2] = x;
+        out[count * 2 + 1] = y;
+        // branchless compaction, the slot just gets overwritten when culled
+        count += (x >= view.x) & (x <= right) & (y >= view.y) & (y <= bottom);
+    }
+    return count;
+}
+
+auto Lou_Math::cull_rects(std::span<const float> rects, SDL_FRect view, std::span<uint32_t> out) -> size_t {
+    const float right = view.x + view.w;
+    const float bottom = view.y + view.h;
+    size_t count{};
+    for (size_t i{}; i + 3 < rects.size() and count < out.size(); i += 4) {
+        const float x = rects[i];
+        const float y = rects[i + 1];
+        out[count] = static_cast<uint32_t>(i / 4);
+        count += (x + rects[i + 2] >= view.x) & (x <= right)
+            & (y + rects[i + 3] >= view.y) & (y <= bottom);
+    }
+    return count;
+}
@@ -0,0 +1,97 @@
+#include "Lou.hpp"
+using Column = blaze::CustomVector<float, blaze::unaligned, blaze::unpadded>;
+
+Lou_Emitter::Lou_Emitter(size_t capacity, uint32_t seed):
+    capacity(capacity),
+    x(capacity), y(capacity), vx(capacity), vy(capacity),
+    age(capacity), age_rate(capacity),
+    random(seed),
+    vertices(capacity * 4),
+    indices(capacity * 6) {
+    for (size_t i{}; i < capacity; ++i) {
+        const int first = static_cast<int>(i * 4);
+        const std::array quad{first, first + 1, first + 2, first, first + 2, first + 3};
+        std::ranges::copy(quad, indices.begin() + i * 6);
+    }
+}
+
+auto Lou_Emitter::burst(SDL_FPoint position, size_t count) -> size_t {
+    count = std::min(count, capacity - live);
+    auto uniform = [this](Range range) {
+        return std::uniform_real_distribution<float>{range.min, range.max}(random);
+    };
+    for (size_t i = live; i < live + count; ++i) {
+        const float angle = direction + uniform({-spread / 2, spread / 2});
+        const float s = uniform(speed);
+        x[i] = position.x;
+        y[i] = position.y;
+        vx[i] = std::cos(angle) * s;
+        vy[i] = std::sin(angle) * s;
+        age[i] = 0;
+        age_rate[i] = 1 / std::max(uniform(lifetime), 1e-3f);
+    }
+    live += count;
+    return count;
+}
+
+auto Lou_Emitter::update(float delta_seconds) -> void {
+    if (live == 0) return;
+    jobs::parallel_for(live, parallel_grain, [&](size_t begin, size_t end) {
+        const size_t n = end - begin;
+        Column px(x.data() + begin, n), py(y.data() + begin, n);
+        Column pvx(vx.data() + begin, n), pvy(vy.data() + begin, n);
+        Column page(age.data() + begin, n), prate(age_rate.data() + begin, n);
+        if (gravity.x != 0) pvx += blaze::UniformVector<float>(n, gravity.x * delta_seconds);
+        if (gravity.y != 0) pvy += blaze::UniformVector<float>(n, gravity.y * delta_seconds);
+        px += pvx * delta_seconds;
+        py += pvy * delta_seconds;
+        page += prate * delta_seconds;
+    });
+    // walking backwards means a swapped in particle has already been checked
+    for (size_t i = live; i-- > 0;) {
+        if (age[i] < 1) continue;
+        const size_t last = --live;
+        x[i] = x[last];
+        y[i] = y[last];
+        vx[i] = vx[last];
+        vy[i] = vy[last];
+        age[i] = age[last];
+        age_rate[i] = age_rate[last];
+    }
+}
+
+auto Lou_Emitter::render(Lou_Renderer& renderer) -> bool {
+    if (live == 0) return true;
+    LOU_TRACE_SCOPE("emitter render");
+    if (not renderer.flush()) return false;
+    auto lerp = [](float a, float b, float t) {return a + (b - a) * t;};
+    for (size_t i{}; i < live; ++i) {
+        const float t = age[i];
+        const float half = lerp(size.min, size.max, t) / 2;
+        const SDL_FColor color{
+            lerp(start_color.r, end_color.r, t),
+            lerp(start_color.g, end_color.g, t),
+            lerp(start_color.b, end_color.b, t),
+            lerp(start_color.a, end_color.a, t),
+        };
+        auto quad = vertices.begin() + i * 4;
+        quad[0] = {.position{x[i] - half, y[i] - half}, .color = color, .tex_coord{0, 0}};
+        quad[1] = {.position{x[i] + half, y[i] - half}, .color = color, .tex_coord{1, 0}};
+        quad[2] = {.position{x[i] + half, y[i] + half}, .color = color, .tex_coord{1, 1}};
+        quad[3] = {.position{x[i] - half, y[i] + half}, .color = color, .tex_coord{0, 1}};
+    }
+    return SDL_RenderGeometry(
+        renderer.get(),
+        texture ? texture->get() : nullptr,
+        vertices.data(),
+        static_cast<int>(live * 4),
+        indices.data(),
+        static_cast<int>(live * 6)
+    );
+}
+
+auto Lou_Particles::update(double delta_seconds) -> void {
+    if (emitters.empty()) return;
+    LOU_TRACE_SCOPE("particles update");
+    for (auto emitter : emitters) emitter->update(static_cast<float>(delta_seconds));
+}
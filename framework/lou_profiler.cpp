@@ -0,0 +1,153 @@
+#include "Lou.hpp"
+namespace fs = std::filesystem;
+
+Lou_Profiler::~Lou_Profiler() {
+    // the vm is gone by now, so only the timer is left to stop
+    sampling = false;
+    if (timer.joinable()) timer.join();
+}
+
+auto Lou_Profiler::start(lua_State* L, std::chrono::microseconds interval) -> void {
+    if (sampling) return;
+    stacks.clear();
+    samples = 0;
+    window.clear();
+    window_samples = 0;
+    window_frame = 0;
+    top.clear();
+    top_samples = 0;
+    this->interval = interval;
+    open = true;
+    sampling = true;
+    lua_callbacks(L)->interrupt = [](lua_State* L, int gc) {
+        if (gc >= 0) return;
+        auto& profiler = Lou_State::from(L).profiler;
+        if (not profiler.sample_requested.exchange(false, std::memory_order_acquire)) return;
+        // requests raised while no luau code was running would otherwise all
+        // be attributed to whatever function happens to run next.
+        const auto age_ns = tracing::now() - profiler.requested_ns.load(std::memory_order_relaxed);
+        const auto interval_ns = std::chrono::nanoseconds(profiler.interval).count();
+        if (age_ns > static_cast<uint64_t>(interval_ns) * 2) return;
+        profiler.sample(L);
+    };
+    timer = std::thread([this] {
+        tracing::set_thread_name("profiler timer");
+        while (sampling.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(this->interval);
+            // a pending request keeps its stamp so it can age past the limit.
+            // only the interrupt clears the flag, so this can't race a reset.
+            if (sample_requested.load(std::memory_order_relaxed)) continue;
+            requested_ns.store(tracing::now(), std::memory_order_relaxed);
+            sample_requested.store(true, std::memory_order_release);
+        }
+    });
+}
+
+auto Lou_Profiler::stop(lua_State* L) -> void {
+    if (not sampling) return;
+    sampling = false;
+    timer.join();
+    lua_callbacks(L)->interrupt = nullptr;
+    sample_requested = false;
+    if (window_samples > 0) close_window();
+}
+
+auto Lou_Profiler::sample(lua_State* L) -> void {
+    frames.clear();
+    lua_Debug ar;
+    for (int level{}; lua_getinfo(L, level, "sn", &ar); ++level) {
+        const char* name = ar.name ? ar.name : "anonymous";
+        auto& frame = frames.emplace_back(ar.linedefined < 0
+            ? std::format("{} [C]", name)
+            : std::format("{} ({}:{})", name, ar.short_src, ar.linedefined)
+        );
+        // ';' separates frames in the folded format
+        std::ranges::replace(frame, ';', ',');
+    }
+    if (frames.empty()) return;
+    std::string folded;
+    for (const auto& frame : frames | std::views::reverse) {
+        if (not folded.empty()) folded += ';';
+        folded += frame;
+    }
+    ++stacks[folded];
+    ++samples;
+    ++window_samples;
+    for (size_t i{}; i < frames.size(); ++i) {
+        // recursive functions count once towards their total
+        if (std::find(frames.begin(), frames.begin() + i, frames[i]) != frames.begin() + i) continue;
+        auto& function = window[frames[i]];
+        if (function.name.empty()) function.name = frames[i];
+        ++function.total;
+        if (i == 0) ++function.self;
+    }
+}
+
+auto Lou_Profiler::close_window() -> void {
+    top.clear();
+    for (auto& [name, function] : window) top.push_back(std::move(function));
+    const size_t count = std::min(top.size(), top_count);
+    std::ranges::partial_sort(top, top.begin() + count, [](const Function_Samples& a, const Function_Samples& b) {
+        return a.self > b.self or (a.self == b.self and a.total > b.total);
+    });
+    top.resize(count);
+    top_samples = window_samples;
+    window.clear();
+    window_samples = 0;
+    window_frame = 0;
+}
+
+auto Lou_Profiler::end_frame() -> void {
+    if (not sampling) return;
+    if (++window_frame >= window_frames) close_window();
+}
+
+auto Lou_Profiler::dump(const fs::path& file) -> std::expected<size_t, std::string> {
+    std::ofstream out{file};
+    if (not out.is_open()) return std::unexpected(std::format("failed to open '{}'", file.string()));
+    for (const auto& [stack, count] : stacks) {
+        out << stack << ' ' << count << '\n';
+    }
+    return stacks.size();
+}
+
+auto Lou_Profiler::toggle_capture(lua_State* L, Lou_Console& console) -> void {
+    if (not sampling) {
+        start(L, default_interval);
+        console.comment("profiler started");
+        return;
+    }
+    stop(L);
+    auto dumped = dump(default_file);
+    if (not dumped) {
+        console.error(dumped.error());
+        return;
+    }
+    console.comment(std::format("wrote {} stacks from {} samples to '{}'", *dumped, samples, default_file));
+}
+
+auto Lou_Profiler::render() -> void {
+    if (not open) return;
+    ImGui::Begin("profiler", &open);
+    ImGui::Text("%s, %llu samples", sampling ? "sampling" : "stopped", static_cast<unsigned long long>(samples));
+    if (top.empty()) {
+        ImGui::TextUnformatted("no complete window yet");
+    } else if (ImGui::BeginTable("top functions", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
+        ImGui::TableSetupColumn("function");
+        ImGui::TableSetupColumn("self", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("total", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableHeadersRow();
+        const double percent = 100.0 / static_cast<double>(top_samples);
+        for (const auto& function : top) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(function.name.data(), function.name.data() + function.name.size());
+            ImGui::TableNextColumn();
+            ImGui::Text("%5.1f%%", static_cast<double>(function.self) * percent);
+            ImGui::TableNextColumn();
+            ImGui::Text("%5.1f%%", static_cast<double>(function.total) * percent);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
@@ -0,0 +1,149 @@
+#include "Lou.hpp"
+#include <map>
+#include <unordered_set>
+namespace fs = std::filesystem;
+namespace rngs = std::ranges;
+
+static constexpr int max_retained_depth = 32;
+
+static auto retain(lua_State* L, int idx, Lou_Refs::Retained& retained, std::unordered_set<const void*>& seen, int depth) -> void {
+    idx = lua_absindex(L, idx);
+    switch (lua_type(L, idx)) {
+        case LUA_TSTRING:
+            retained.string_bytes += lua_objlen(L, idx);
+            return;
+        case LUA_TBUFFER:
+            if (seen.insert(lua_topointer(L, idx)).second) retained.buffer_bytes += lua_objlen(L, idx);
+            return;
+        case LUA_TUSERDATA:
+            // the metatables are shared per type, so there's nothing to follow
+            if (seen.insert(lua_topointer(L, idx)).second) ++retained.userdata;
+            return;
+        case LUA_TTABLE:
+        case LUA_TFUNCTION:
+            break;
+        default:
+            return;
+    }
+    if (not seen.insert(lua_topointer(L, idx)).second) return;
+    if (lua_istable(L, idx)) {
+        ++retained.tables;
+    } else {
+        ++retained.functions;
+    }
+    if (depth == max_retained_depth or not lua_checkstack(L, 3)) return;
+    if (lua_isfunction(L, idx)) {
+        for (int n{1}; lua_getupvalue(L, idx, n); ++n) {
+            retain(L, -1, retained, seen, depth + 1);
+            lua_pop(L, 1);
+        }
+        return;
+    }
+    if (lua_getmetatable(L, idx)) {
+        retain(L, -1, retained, seen, depth + 1);
+        lua_pop(L, 1);
+    }
+    lua_pushnil(L);
+    while (lua_next(L, idx)) {
+        retain(L, -2, retained, seen, depth + 1);
+        retain(L, -1, retained, seen, depth + 1);
+        lua_pop(L, 1);
+    }
+}
+
+auto Lou_Refs::subsystem(int tag) -> std::string_view {
+    // pointers pushed with push_tagged may carry the reference tag
+    auto found = from_userdata_tag(tag);
+    if (not found or *found == Tag::Unknown) return "script";
+    return compile_time::enum_item<Tag>(static_cast<int>(*found)).name;
+}
+
+auto Lou_Refs::dump(lua_State* L, const fs::path& file) -> std::expected<size_t, std::string> {
+    std::ofstream out{file};
+    if (not out.is_open()) return std::unexpected(std::format("failed to open '{}'", file.string()));
+    struct Entry {
+        int ref;
+        lua::Ref_Origin origin;
+        const char* type;
+        Retained retained;
+    };
+    std::vector<Entry> entries;
+    if (not lua_checkstack(L, 1)) return std::unexpected("stack overflow while dumping refs");
+    for (auto& [ref, origin] : lua::ref_audit.live(lua_mainthread(L))) {
+        auto& entry = entries.emplace_back(ref, std::move(origin));
+        std::unordered_set<const void*> seen;
+        lua_getref(L, ref);
+        entry.type = luaL_typename(L, -1);
+        retain(L, -1, entry.retained, seen, 0);
+        lua_pop(L, 1);
+    }
+    auto objects = [](const Retained& r) {return r.tables + r.functions + r.userdata;};
+    rngs::sort(entries, [&](const Entry& a, const Entry& b) {
+        return objects(a.retained) > objects(b.retained);
+    });
+    for (const auto& [ref, origin, type, retained] : entries) {
+        out << std::format(
+            "{} {} ref {} ({}): {} tables, {} functions, {} userdata, {} string bytes, {} buffer bytes\n",
+            subsystem(origin.tag), origin.site, ref, type,
+            retained.tables, retained.functions, retained.userdata,
+            retained.string_bytes, retained.buffer_bytes
+        );
+    }
+    return entries.size();
+}
+
+auto Lou_Refs::render(lua_State* L, Lou_Console& console) -> void {
+    if (not open) return;
+    ImGui::Begin("refs", &open);
+    const auto live = lua::ref_audit.live(lua_mainthread(L));
+    ImGui::Text("%zu live refs", live.size());
+    ImGui::SameLine();
+    if (ImGui::Button("dump")) {
+        auto dumped = dump(L, default_file);
+        if (dumped) {
+            console.comment(std::format("wrote {} refs to '{}'", *dumped, default_file));
+        } else {
+            console.error(dumped.error());
+        }
+    }
+    std::map<std::string_view, size_t> per_subsystem;
+    std::map<std::pair<std::string_view, std::string_view>, size_t> per_site;
+    for (const auto& [ref, origin] : live) {
+        ++per_subsystem[subsystem(origin.tag)];
+        ++per_site[{subsystem(origin.tag), origin.site}];
+    }
+    if (ImGui::BeginTable("subsystems", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
+        ImGui::TableSetupColumn("subsystem");
+        ImGui::TableSetupColumn("refs", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableHeadersRow();
+        for (const auto& [name, count] : per_subsystem) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(name.data(), name.data() + name.size());
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", count);
+        }
+        ImGui::EndTable();
+    }
+    // the sites holding on to the most refs are the likeliest leaks
+    std::vector sites(per_site.begin(), per_site.end());
+    rngs::sort(sites, std::greater{}, [](const auto& site) {return site.second;});
+    if (ImGui::BeginTable("sites", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
+        ImGui::TableSetupColumn("subsystem");
+        ImGui::TableSetupColumn("created at");
+        ImGui::TableSetupColumn("refs", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableHeadersRow();
+        for (const auto& [key, count] : sites) {
+            const auto& [name, site] = key;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(name.data(), name.data() + name.size());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(site.data(), site.data() + site.size());
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", count);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
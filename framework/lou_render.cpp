@@ -1,33 +1,66 @@
 #include "Lou.hpp"
+#include <cmath>
+#include <numbers>
 
 
+auto Lou_Console::flush_pending() -> void {
+    while (auto entry = pending.pop()) {
+        // split into single lines so every row has the same height for the clipper.
+        for (auto line : std::views::split(entry->message, '\n')) {
+            if (line.empty()) continue;
+            entries.push({
+                .severity = entry->severity,
+                .time = entry->time,
+                .message = std::string(line.begin(), line.end()),
+            });
+        }
+        is_dirty = true;
+        changed = true;
+    }
+}
+static auto format_time_stamp(std::chrono::system_clock::time_point time, std::span<char> out) -> const char* {
+    using namespace std::chrono;
+    static const auto zone = current_zone();
+    auto local = zoned_time(zone, time_point_cast<duration<long long, std::centi>>(time));
+    auto result = std::format_to_n(out.data(), out.size() - 1, "[{:%T}]: ", local);
+    *result.out = '\0';
+    return out.data();
+}
 auto Lou_Console::render() -> void {
-    auto& io = ImGui::GetIO();
     if (ImGui::IsKeyPressed(ImGuiKey_F9)) {
         open = not open;
     }
+    flush_pending();
     if (open) {
         ImGui::Begin("console", &open);
-        for (const auto& entry : entries) {
-            switch (entry.severity) {
-                case Severity::Error:
-                    ImGui::PushStyleColor(ImGuiCol_Text, 0xff0000ff);
-                break;
-                case Severity::Warning:
-                    ImGui::PushStyleColor(ImGuiCol_Text, 0xffff00ff);
-                break;
-                case Severity::Comment:
-                break;
-            }
-            ImGui::TextWrapped("%s", entry.message.c_str());
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(entries.size()));
+        std::array<char, 32> stamp;
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                const auto& entry = entries[i];
+                switch (entry.severity) {
+                    case Severity::Error:
+                        ImGui::PushStyleColor(ImGuiCol_Text, 0xff0000ff);
+                    break;
+                    case Severity::Warning:
+                        ImGui::PushStyleColor(ImGuiCol_Text, 0xffff00ff);
+                    break;
+                    case Severity::Comment:
+                    break;
+                }
+                ImGui::TextUnformatted(format_time_stamp(entry.time, stamp));
+                ImGui::SameLine(0, 0);
+                ImGui::TextUnformatted(entry.message.data(), entry.message.data() + entry.message.size());
 
-            switch (entry.severity) {
-                case Severity::Warning:
-                case Severity::Error:
-                    ImGui::PopStyleColor();
-                break;
-                default:
-                break;
+                switch (entry.severity) {
+                    case Severity::Warning:
+                    case Severity::Error:
+                        ImGui::PopStyleColor();
+                    break;
+                    default:
+                    break;
+                }
             }
         }
         if (is_dirty) {
@@ -37,16 +70,230 @@ auto Lou_Console::render() -> void {
         ImGui::End();
     }
 }
+auto Lou_State::needs_redraw() -> bool {
+    if (frame.redraw_requested or frame.settle_frames > 0 or console.changed) return true;
+    auto& io = ImGui::GetIO();
+    return io.WantTextInput or ImGui::IsAnyItemActive();
+}
 void Lou_State::render() {
+    if (frame.idle_mode and not needs_redraw()) {
+        ++frame.skipped;
+        return;
+    }
+    LOU_TRACE_SCOPE("render");
+    frame.redraw_requested = false;
+    console.changed = false;
+    if (frame.settle_frames > 0) --frame.settle_frames;
+    ++frame.rendered;
     auto r = renderer.get();
     ImGui_ImplSDL3_NewFrame();
     ImGui_ImplSDLRenderer3_NewFrame();
     ImGui::NewFrame();
+    auto scaled = renderer.begin_scaled_frame();
+    if (not scaled) {
+        console.error(std::format("dynamic resolution was disabled: {}", scaled.error()));
+        renderer.resolution.enabled = false;
+    }
     SDL_SetRenderDrawColor(r, 0x0, 0x0, 0x0, 0x0);
     SDL_RenderClear(r);
+    entities.render(lua_state(), renderer, console);
     on_render.call(lua_state(), console);
+    renderer.flush();
+    // ImGui is drawn on top at full resolution
+    if (scaled and *scaled and not renderer.present_scaled_frame()) console.error(SDL_GetError());
+    // captured frames leave out the debug windows
+    renderer.capture.read_frame(r, console);
     console.render();
+    profiler.render();
+    refs.render(lua_state(), console);
     ImGui::Render();
     ImGui_ImplSDLRenderer3_RenderDrawData(ImGui::GetDrawData(), r);
-    SDL_RenderPresent(r);
+    using namespace std::chrono;
+    // measured before presenting so waiting on vsync doesn't count as work
+    renderer.update_resolution(duration<float, std::milli>(Clock_t::now() - frame.work_start).count());
+    {
+        LOU_TRACE_SCOPE("present");
+        SDL_RenderPresent(r);
+    }
+    if (frame.collect_work_ms) {
+        frame.work_ms.push_back(duration<float, std::milli>(Clock_t::now() - frame.work_start).count());
+    }
+}
+auto Lou_Renderer::begin_scaled_frame() -> std::expected<bool, std::string> {
+    auto& target = resolution.target;
+    if (not resolution.enabled) {
+        // released here rather than when disabled, it may still be bound then
+        target.reset();
+        resolution.scale = 1;
+        return false;
+    }
+    auto r = get();
+    int w, h;
+    if (not SDL_GetRenderOutputSize(r, &w, &h)) return std::unexpected(SDL_GetError());
+    if (not target or target->size.x != w or target->size.y != h) {
+        target.reset();
+        auto created = Lou_Create_Texture{r}.render_target(w, h);
+        if (not created) return std::unexpected(created.error());
+        SDL_SetTextureBlendMode(created->get(), SDL_BLENDMODE_NONE);
+        SDL_SetTextureScaleMode(created->get(), SDL_SCALEMODE_LINEAR);
+        target = std::move(*created);
+    }
+    // the render scale belongs to the target, so texture redraws switching
+    // targets in between still draw at their own size.
+    if (not SDL_SetRenderTarget(r, target->get())) return std::unexpected(SDL_GetError());
+    if (not SDL_SetRenderScale(r, resolution.scale, resolution.scale)) return std::unexpected(SDL_GetError());
+    return true;
+}
+auto Lou_Renderer::present_scaled_frame() -> bool {
+    auto r = get();
+    auto& target = *resolution.target;
+    SDL_SetRenderScale(r, 1, 1);
+    if (not SDL_SetRenderTarget(r, nullptr)) return false;
+    SDL_SetRenderDrawColor(r, 0x0, 0x0, 0x0, 0x0);
+    SDL_RenderClear(r);
+    const SDL_FRect source{0, 0, target.size.x * resolution.scale, target.size.y * resolution.scale};
+    return SDL_RenderTexture(r, target.get(), &source, nullptr);
+}
+auto Lou_Renderer::update_resolution(float frame_ms) -> void {
+    auto& res = resolution;
+    if (not res.enabled) return;
+    res.average_ms = res.average_ms == 0 ? frame_ms : std::lerp(res.average_ms, frame_ms, res.smoothing);
+    if (res.cooldown > 0) {
+        --res.cooldown;
+        return;
+    }
+    // going down as soon as the budget is exceeded but only back up with
+    // headroom keeps the scale from flickering around the budget.
+    float next = res.scale;
+    if (res.average_ms > res.budget_ms) {
+        next -= res.step;
+    } else if (res.average_ms < res.budget_ms * res.headroom) {
+        next += res.step;
+    }
+    next = std::clamp(next, res.min_scale, res.max_scale);
+    if (next == res.scale) return;
+    res.scale = next;
+    res.cooldown = res.settle_frames;
+}
+// render targets by address, weak valued so it never keeps one alive. the
+// draw function is reached through the texture's own metatable from there.
+static constexpr auto render_targets_name = "lou_render_targets";
+static auto push_render_targets(lua_State* L) -> void {
+    lua_getfield(L, LUA_REGISTRYINDEX, render_targets_name);
+    if (lua_istable(L, -1)) return;
+    lua_pop(L, 1);
+    lua_newtable(L);
+    lua_newtable(L);
+    lua_pushstring(L, "v");
+    lua_setfield(L, -2, "__mode");
+    lua_setmetatable(L, -2);
+    lua_pushvalue(L, -1);
+    lua_setfield(L, LUA_REGISTRYINDEX, render_targets_name);
+}
+auto Lou_Texture::set_draw_fn(lua_State* L, int idx, int fn_idx) -> void {
+    idx = lua_absindex(L, idx);
+    fn_idx = lua_absindex(L, fn_idx);
+    lua_newtable(L);
+    lua_getmetatable(L, idx);
+    lua_pushnil(L);
+    while (lua_next(L, -2)) {
+        lua_pushvalue(L, -2);
+        lua_insert(L, -2);
+        lua_rawset(L, -5);
+    }
+    lua_pop(L, 1);
+    lua_pushvalue(L, fn_idx);
+    lua_setfield(L, -2, "draw");
+    lua_setmetatable(L, idx);
+    push_render_targets(L);
+    lua_pushlightuserdata(L, this);
+    lua_pushvalue(L, idx);
+    lua_rawset(L, -3);
+    lua_pop(L, 1);
+    render_target = true;
+}
+auto Lou_Texture::redraw(lua_State* L) -> std::expected<void, std::string> {
+    auto texture = get();
+    auto renderer = SDL_GetRendererFromTexture(texture);
+    if (not renderer) return std::unexpected(SDL_GetError());
+    auto& batch = Lou_State::from(L).renderer;
+    if (not batch.flush()) return std::unexpected(SDL_GetError());
+    auto previous_target = SDL_GetRenderTarget(renderer);
+    if (not SDL_SetRenderTarget(renderer, texture)) return std::unexpected(SDL_GetError());
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+    SDL_SetRenderDrawColor(renderer, 0x0, 0x0, 0x0, 0x0);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    push_render_targets(L);
+    lua_pushlightuserdata(L, this);
+    lua_rawget(L, -2);
+    lua_getmetatable(L, -1);
+    lua_getfield(L, -1, "draw");
+    lua_replace(L, -4);
+    lua_pop(L, 2);
+    lua::values(L, size.x, size.y);
+    const int status = lua_pcall(L, 2, 0, 0);
+    batch.flush();
+    SDL_SetRenderTarget(renderer, previous_target);
+    dirty = false;
+    if (status != LUA_OK) {
+        std::string runtime_error{lua_tostring(L, -1)};
+        lua_pop(L, 1);
+        return std::unexpected(std::move(runtime_error));
+    }
+    return {};
+}
+auto Lou_Renderer::draw_sprite(const Lou_Texture& texture, const Sprite& sprite) -> bool {
+    auto ptr = texture.ptr.get();
+    if (batch.texture != ptr) {
+        if (not flush()) return false;
+        batch.texture = ptr;
+    }
+    const auto& src = sprite.source;
+    const auto& dst = sprite.destination;
+    float u0 = src.x / texture.size.x;
+    float v0 = src.y / texture.size.y;
+    float u1 = (src.x + src.w) / texture.size.x;
+    float v1 = (src.y + src.h) / texture.size.y;
+    if (sprite.flip & SDL_FLIP_HORIZONTAL) std::swap(u0, u1);
+    if (sprite.flip & SDL_FLIP_VERTICAL) std::swap(v0, v1);
+    const auto pivot = sprite.pivot.value_or(SDL_FPoint{dst.w / 2, dst.h / 2});
+    const double radians = sprite.angle * std::numbers::pi / 180.0;
+    const auto cosine = static_cast<float>(std::cos(radians));
+    const auto sine = static_cast<float>(std::sin(radians));
+    // geometry ignores the texture color mod, so it's baked into the vertices
+    auto corner = [&](float x, float y, float u, float v) -> SDL_Vertex {
+        x -= pivot.x;
+        y -= pivot.y;
+        return {
+            .position{dst.x + pivot.x + x * cosine - y * sine, dst.y + pivot.y + x * sine + y * cosine},
+            .color = texture.color,
+            .tex_coord{u, v},
+        };
+    };
+    const int first = static_cast<int>(batch.vertices.size());
+    batch.vertices.push_back(corner(0, 0, u0, v0));
+    batch.vertices.push_back(corner(dst.w, 0, u1, v0));
+    batch.vertices.push_back(corner(dst.w, dst.h, u1, v1));
+    batch.vertices.push_back(corner(0, dst.h, u0, v1));
+    for (int i : {0, 1, 2, 0, 2, 3}) batch.indices.push_back(first + i);
+    if (batch.vertices.size() >= max_batch_vertices) return flush();
+    return true;
+}
+auto Lou_Renderer::flush() -> bool {
+    if (batch.indices.empty()) return true;
+    LOU_TRACE_SCOPE("sprite batch");
+    const bool submitted = SDL_RenderGeometry(
+        get(),
+        batch.texture,
+        batch.vertices.data(),
+        static_cast<int>(batch.vertices.size()),
+        batch.indices.data(),
+        static_cast<int>(batch.indices.size())
+    );
+    batch.vertices.clear();
+    batch.indices.clear();
+    batch.texture = nullptr;
+    return submitted;
 }
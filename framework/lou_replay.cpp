@@ -0,0 +1,126 @@
+#include "Lou.hpp"
+#include <algorithm>
+namespace fs = std::filesystem;
+
+// a frame is stored as: f64 delta, u16 event count, then per event
+// u32 type, u8 size and the leading `size` bytes of the SDL_Event.
+static auto event_size(const SDL_Event& e) -> uint8_t {
+    switch (e.type) {
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP:
+            return sizeof(e.key);
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP:
+            return sizeof(e.button);
+        case SDL_EVENT_MOUSE_MOTION:
+            return sizeof(e.motion);
+        case SDL_EVENT_MOUSE_WHEEL:
+            return sizeof(e.wheel);
+        default:
+            return 0;
+    }
+}
+template <class Ty>
+static void write_raw(std::ofstream& out, const Ty& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(Ty));
+}
+template <class Ty>
+static auto read_raw(std::ifstream& in, Ty& value) -> bool {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(Ty)));
+}
+
+auto Lou_Replay::is_recordable(const SDL_Event& e) -> bool {
+    return event_size(e) != 0;
+}
+
+auto Lou_Replay::start_recording(const fs::path& file) -> std::expected<void, std::string> {
+    output.open(file, std::ios::binary);
+    if (not output.is_open()) return std::unexpected(std::format("failed to open '{}'", file.string()));
+    seed = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+    output.write(magic.data(), magic.size());
+    write_raw(output, version);
+    write_raw(output, seed);
+    mode = Mode::Record;
+    return {};
+}
+
+auto Lou_Replay::start_replay(const fs::path& file, double fixed_delta) -> std::expected<void, std::string> {
+    input.open(file, std::ios::binary);
+    if (not input.is_open()) return std::unexpected(std::format("failed to open '{}'", file.string()));
+    std::array<char, 4> header;
+    uint32_t file_version;
+    input.read(header.data(), header.size());
+    if (header != magic or not read_raw(input, file_version) or file_version != version) {
+        return std::unexpected(std::format("'{}' is not a compatible recording", file.string()));
+    }
+    if (not read_raw(input, seed)) return std::unexpected("recording is truncated");
+    this->fixed_delta = fixed_delta;
+    mode = Mode::Replay;
+    return {};
+}
+
+auto Lou_Replay::record_event(const SDL_Event& e) -> void {
+    if (mode != Mode::Record or not is_recordable(e)) return;
+    frame_events.push_back(e);
+}
+
+auto Lou_Replay::end_frame(double delta_seconds) -> void {
+    if (mode != Mode::Record) return;
+    write_raw(output, delta_seconds);
+    write_raw(output, static_cast<uint16_t>(std::min<size_t>(frame_events.size(), UINT16_MAX)));
+    for (const auto& e : frame_events | std::views::take(UINT16_MAX)) {
+        const uint32_t type = e.type;
+        const uint8_t size = event_size(e);
+        write_raw(output, type);
+        write_raw(output, size);
+        output.write(reinterpret_cast<const char*>(&e), size);
+    }
+    frame_events.clear();
+}
+
+auto Lou_Replay::next_frame(double& delta_seconds) -> bool {
+    frame_events.clear();
+    uint16_t count;
+    if (not read_raw(input, delta_seconds) or not read_raw(input, count)) return false;
+    for (uint16_t i{}; i < count; ++i) {
+        uint32_t type;
+        uint8_t size;
+        if (not read_raw(input, type) or not read_raw(input, size)) return false;
+        SDL_Event e{};
+        if (size > sizeof(SDL_Event)) return false;
+        if (not input.read(reinterpret_cast<char*>(&e), size)) return false;
+        e.type = type;
+        frame_events.push_back(e);
+    }
+    if (fixed_delta > 0) delta_seconds = fixed_delta;
+    return true;
+}
+
+auto Lou_State::frame_time_summary() -> Frame_Time_Summary {
+    if (frame.work_ms.empty()) return {};
+    auto sorted = frame.work_ms;
+    std::ranges::sort(sorted);
+    auto percentile = [&sorted](double p) -> double {
+        const auto idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+        return sorted[idx];
+    };
+    double total{};
+    for (float ms : sorted) total += ms;
+    return {
+        .frames = sorted.size(),
+        .mean_ms = total / static_cast<double>(sorted.size()),
+        .p50_ms = percentile(.5),
+        .p95_ms = percentile(.95),
+        .p99_ms = percentile(.99),
+        .max_ms = sorted.back(),
+    };
+}
+
+auto Lou_State::frame_time_report() -> std::string {
+    if (frame.work_ms.empty()) return "no frames were measured";
+    auto s = frame_time_summary();
+    return std::format(
+        "frames: {}, mean: {:.3f}ms, p50: {:.3f}ms, p95: {:.3f}ms, p99: {:.3f}ms, max: {:.3f}ms",
+        s.frames, s.mean_ms, s.p50_ms, s.p95_ms, s.p99_ms, s.max_ms
+    );
+}
@@ -0,0 +1,207 @@
+#include "Lou.hpp"
+#include <cmath>
+
+static constexpr auto cell_key(int x, int y) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+static constexpr auto overlaps(const SDL_FRect& a, const SDL_FRect& b) -> bool {
+    return a.x <= b.x + b.w and b.x <= a.x + a.w
+        and a.y <= b.y + b.h and b.y <= a.y + a.h;
+}
+
+// cell coordinates stay far enough inside int that iterating a range can't
+// overflow, rects beyond that share the outermost cells.
+static constexpr float max_cell = 1 << 30;
+static auto to_cell(float coordinate, float cell_size) -> int {
+    return static_cast<int>(std::clamp(std::floor(coordinate / cell_size), -max_cell, max_cell));
+}
+static constexpr auto cell_count(const Lou_Spatial_Hash::Cell_Range& range) -> uint64_t {
+    if (range.x1 < range.x0 or range.y1 < range.y0) return 0;
+    return static_cast<uint64_t>(int64_t{range.x1} - range.x0 + 1) * static_cast<uint64_t>(int64_t{range.y1} - range.y0 + 1);
+}
+
+auto Lou_Spatial_Hash::cell_range(SDL_FRect rect) const -> Cell_Range {
+    return {
+        to_cell(rect.x, cell_size),
+        to_cell(rect.y, cell_size),
+        to_cell(rect.x + rect.w, cell_size),
+        to_cell(rect.y + rect.h, cell_size),
+    };
+}
+
+auto Lou_Spatial_Hash::link(Id id) -> void {
+    auto& body = bodies[id];
+    body.oversized = cell_count(body.cells) > max_body_cells;
+    if (body.oversized) {
+        oversized.push_back(id);
+        return;
+    }
+    const auto& range = body.cells;
+    for (int y = range.y0; y <= range.y1; ++y) {
+        for (int x = range.x0; x <= range.x1; ++x) cells[cell_key(x, y)].push_back(id);
+    }
+}
+
+auto Lou_Spatial_Hash::unlink(Id id) -> void {
+    auto remove_from = [id](std::vector<Id>& ids) {
+        auto it = std::ranges::find(ids, id);
+        if (it == ids.end()) return;
+        *it = ids.back();
+        ids.pop_back();
+    };
+    const auto& body = bodies[id];
+    if (body.oversized) {
+        remove_from(oversized);
+        return;
+    }
+    const auto& range = body.cells;
+    for (int y = range.y0; y <= range.y1; ++y) {
+        for (int x = range.x0; x <= range.x1; ++x) {
+            auto found = cells.find(cell_key(x, y));
+            // the vector keeps its capacity for bodies moving back in
+            if (found != cells.end()) remove_from(found->second);
+        }
+    }
+}
+
+auto Lou_Spatial_Hash::next_stamp() -> uint32_t {
+    if (visited.size() < bodies.size()) visited.resize(bodies.size(), 0);
+    if (++query_stamp == 0) {
+        std::ranges::fill(visited, 0);
+        query_stamp = 1;
+    }
+    return query_stamp;
+}
+
+auto Lou_Spatial_Hash::insert(SDL_FRect rect) -> Id {
+    Id id;
+    if (not free_ids.empty()) {
+        id = free_ids.back();
+        free_ids.pop_back();
+    } else {
+        id = static_cast<Id>(bodies.size());
+        bodies.emplace_back();
+    }
+    bodies[id] = {.rect = rect, .cells = cell_range(rect), .alive = true, .oversized = false};
+    link(id);
+    return id;
+}
+
+auto Lou_Spatial_Hash::move(Id id, SDL_FRect rect) -> void {
+    auto& body = bodies[id];
+    body.rect = rect;
+    const auto range = cell_range(rect);
+    // most moves stay within the same cells and don't touch the grid at all
+    if (range == body.cells) return;
+    unlink(id);
+    body.cells = range;
+    link(id);
+}
+
+auto Lou_Spatial_Hash::remove(Id id) -> void {
+    auto& body = bodies[id];
+    unlink(id);
+    body.alive = false;
+    free_ids.push_back(id);
+}
+
+auto Lou_Spatial_Hash::query_point(SDL_FPoint point, std::span<Id> out) -> size_t {
+    size_t count{};
+    auto visit = [&](Id id) {
+        const auto& r = bodies[id].rect;
+        if (point.x < r.x or point.y < r.y or point.x > r.x + r.w or point.y > r.y + r.h) return true;
+        if (count == out.size()) return false;
+        out[count++] = id;
+        return true;
+    };
+    for (Id id : oversized) {
+        if (not visit(id)) return count;
+    }
+    auto found = cells.find(cell_key(to_cell(point.x, cell_size), to_cell(point.y, cell_size)));
+    if (found == cells.end()) return count;
+    for (Id id : found->second) {
+        if (not visit(id)) break;
+    }
+    return count;
+}
+
+auto Lou_Spatial_Hash::query_rect(SDL_FRect rect, std::span<Id> out) -> size_t {
+    const auto range = cell_range(rect);
+    const uint32_t stamp = next_stamp();
+    size_t count{};
+    // false once `out` is full
+    auto visit = [&](Id id) {
+        if (visited[id] == stamp) return true;
+        visited[id] = stamp;
+        if (not overlaps(rect, bodies[id].rect)) return true;
+        if (count == out.size()) return false;
+        out[count++] = id;
+        return true;
+    };
+    for (Id id : oversized) {
+        if (not visit(id)) return count;
+    }
+    // queries larger than the occupied part of the grid walk its cells
+    // instead of the mostly empty range
+    if (cell_count(range) > cells.size()) {
+        for (const auto& [key, ids] : cells) {
+            const int x = static_cast<int>(static_cast<uint32_t>(key >> 32));
+            const int y = static_cast<int>(static_cast<uint32_t>(key));
+            if (x < range.x0 or x > range.x1 or y < range.y0 or y > range.y1) continue;
+            for (Id id : ids) {
+                if (not visit(id)) return count;
+            }
+        }
+        return count;
+    }
+    for (int y = range.y0; y <= range.y1; ++y) {
+        for (int x = range.x0; x <= range.x1; ++x) {
+            auto found = cells.find(cell_key(x, y));
+            if (found == cells.end()) continue;
+            for (Id id : found->second) {
+                if (not visit(id)) return count;
+            }
+        }
+    }
+    return count;
+}
+
+auto Lou_Spatial_Hash::pairs(std::span<Id> out) -> size_t {
+    const size_t capacity = out.size() / 2;
+    size_t count{};
+    for (const auto& [key, ids] : cells) {
+        const int cell_x = static_cast<int>(static_cast<uint32_t>(key >> 32));
+        const int cell_y = static_cast<int>(static_cast<uint32_t>(key));
+        for (size_t i{}; i < ids.size(); ++i) {
+            const auto& a = bodies[ids[i]];
+            for (size_t j = i + 1; j < ids.size(); ++j) {
+                const auto& b = bodies[ids[j]];
+                if (not overlaps(a.rect, b.rect)) continue;
+                // a pair sharing several cells is only reported by the cell
+                // holding the top left corner of their overlap.
+                const int owner_x = std::max(a.cells.x0, b.cells.x0);
+                const int owner_y = std::max(a.cells.y0, b.cells.y0);
+                if (owner_x != cell_x or owner_y != cell_y) continue;
+                if (count == capacity) return count;
+                out[count * 2] = ids[i];
+                out[count * 2 + 1] = ids[j];
+                ++count;
+            }
+        }
+    }
+    // oversized bodies are few, they're tested against every other body
+    for (Id a : oversized) {
+        for (Id b{}; b < bodies.size(); ++b) {
+            const auto& other = bodies[b];
+            if (b == a or not other.alive) continue;
+            // two oversized bodies are reported once, by the lower id
+            if (other.oversized and b < a) continue;
+            if (not overlaps(bodies[a].rect, other.rect)) continue;
+            if (count == capacity) return count;
+            out[count * 2] = a;
+            out[count * 2 + 1] = b;
+            ++count;
+        }
+    }
+    return count;
+}
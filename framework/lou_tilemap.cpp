@@ -0,0 +1,141 @@
+#include "Lou.hpp"
+#include <cmath>
+
+Lou_Tilemap::Lou_Tilemap(Lou_Texture& tileset, lua::Ref tileset_ref, SDL_FPoint tile_size, int width, int height):
+    width(width),
+    height(height),
+    tile_size(tile_size),
+    tileset(&tileset),
+    tileset_ref(std::move(tileset_ref)),
+    tiles(static_cast<size_t>(width) * height, 0),
+    chunk_columns((width + chunk_tiles - 1) / chunk_tiles),
+    chunk_rows((height + chunk_tiles - 1) / chunk_tiles),
+    chunks(static_cast<size_t>(chunk_columns) * chunk_rows) {
+}
+
+auto Lou_Tilemap::set(int x, int y, uint16_t tile) -> void {
+    auto& current = tiles[static_cast<size_t>(y) * width + x];
+    if (current == tile) return;
+    auto& chunk = chunk_of(x, y);
+    if (current == 0) ++chunk.filled;
+    if (tile == 0) --chunk.filled;
+    current = tile;
+    chunk.dirty = true;
+}
+
+auto Lou_Tilemap::evict_for_bake(Lou_Renderer& renderer) -> void {
+    const size_t chunk_bytes = static_cast<size_t>(tile_size.x * chunk_tiles) * static_cast<size_t>(tile_size.y * chunk_tiles) * 4;
+    const size_t max_baked = std::max<size_t>(baked_budget_bytes / std::max<size_t>(chunk_bytes, 1), 1);
+    while (baked.size() >= max_baked) {
+        auto oldest = std::ranges::min_element(baked, {}, [this](int index) {return chunks[index].last_drawn;});
+        auto& chunk = chunks[*oldest];
+        if (chunk.last_drawn == render_count) return;
+        renderer.release(chunk.texture->get());
+        chunk.texture.reset();
+        chunk.dirty = true;
+        *oldest = baked.back();
+        baked.pop_back();
+    }
+}
+
+auto Lou_Tilemap::bake(Lou_Renderer& renderer, int chunk_x, int chunk_y) -> std::expected<void, std::string> {
+    LOU_TRACE_SCOPE("tilemap bake");
+    auto& chunk = chunks[chunk_y * chunk_columns + chunk_x];
+    auto r = renderer.get();
+    if (not chunk.texture) {
+        evict_for_bake(renderer);
+        auto created = Lou_Create_Texture{r}.render_target(
+            static_cast<int>(tile_size.x * chunk_tiles),
+            static_cast<int>(tile_size.y * chunk_tiles)
+        );
+        if (not created) return std::unexpected(created.error());
+        chunk.texture = std::move(*created);
+        baked.push_back(chunk_y * chunk_columns + chunk_x);
+    }
+    if (not renderer.flush()) return std::unexpected(SDL_GetError());
+    auto previous_target = SDL_GetRenderTarget(r);
+    if (not SDL_SetRenderTarget(r, chunk.texture->get())) return std::unexpected(SDL_GetError());
+    Uint8 red, green, blue, alpha;
+    SDL_GetRenderDrawColor(r, &red, &green, &blue, &alpha);
+    SDL_SetRenderDrawColor(r, 0x0, 0x0, 0x0, 0x0);
+    SDL_RenderClear(r);
+    SDL_SetRenderDrawColor(r, red, green, blue, alpha);
+    // all tiles of a chunk come from the tileset, so they end up in one batch
+    const int columns = static_cast<int>(tileset->size.x / tile_size.x);
+    const int first_x = chunk_x * chunk_tiles;
+    const int first_y = chunk_y * chunk_tiles;
+    const int last_x = std::min(first_x + chunk_tiles, width);
+    const int last_y = std::min(first_y + chunk_tiles, height);
+    bool drawn{true};
+    for (int y = first_y; y < last_y and drawn; ++y) {
+        for (int x = first_x; x < last_x and drawn; ++x) {
+            const int tile = tiles[static_cast<size_t>(y) * width + x];
+            if (tile == 0) continue;
+            const int index = tile - 1;
+            drawn = renderer.draw_sprite(*tileset, {
+                .source = {
+                    (index % columns) * tile_size.x,
+                    (index / columns) * tile_size.y,
+                    tile_size.x,
+                    tile_size.y,
+                },
+                .destination = {
+                    (x - first_x) * tile_size.x,
+                    (y - first_y) * tile_size.y,
+                    tile_size.x,
+                    tile_size.y,
+                },
+            });
+        }
+    }
+    drawn = renderer.flush() and drawn;
+    SDL_SetRenderTarget(r, previous_target);
+    if (not drawn) return std::unexpected(SDL_GetError());
+    chunk.dirty = false;
+    return {};
+}
+
+auto Lou_Tilemap::render(Lou_Renderer& renderer, SDL_FPoint position, SDL_FRect view) -> std::expected<void, std::string> {
+    LOU_TRACE_SCOPE("tilemap render");
+    const float chunk_w = tile_size.x * chunk_tiles;
+    const float chunk_h = tile_size.y * chunk_tiles;
+    auto first = [](float from, float extent, int count) {
+        return std::clamp(static_cast<int>(std::floor(from / extent)), 0, count);
+    };
+    auto last = [](float to, float extent, int count) {
+        return std::clamp(static_cast<int>(std::ceil(to / extent)), 0, count);
+    };
+    const int first_x = first(view.x - position.x, chunk_w, chunk_columns);
+    const int first_y = first(view.y - position.y, chunk_h, chunk_rows);
+    const int last_x = last(view.x + view.w - position.x, chunk_w, chunk_columns);
+    const int last_y = last(view.y + view.h - position.y, chunk_h, chunk_rows);
+    // everything visible is stamped up front, so baking one visible chunk
+    // never evicts another one
+    ++render_count;
+    for (int chunk_y = first_y; chunk_y < last_y; ++chunk_y) {
+        for (int chunk_x = first_x; chunk_x < last_x; ++chunk_x) {
+            chunks[chunk_y * chunk_columns + chunk_x].last_drawn = render_count;
+        }
+    }
+    for (int chunk_y = first_y; chunk_y < last_y; ++chunk_y) {
+        for (int chunk_x = first_x; chunk_x < last_x; ++chunk_x) {
+            auto& chunk = chunks[chunk_y * chunk_columns + chunk_x];
+            if (chunk.filled == 0) continue;
+            if (chunk.dirty) {
+                auto baked = bake(renderer, chunk_x, chunk_y);
+                if (not baked) return baked;
+            }
+            const bool drawn = renderer.draw_sprite(*chunk.texture, {
+                .source = chunk.texture->source_rect(),
+                .destination = {
+                    position.x + chunk_x * chunk_w,
+                    position.y + chunk_y * chunk_h,
+                    chunk_w,
+                    chunk_h,
+                },
+            });
+            if (not drawn) return std::unexpected(SDL_GetError());
+        }
+    }
+    return {};
+}
@@ -23,7 +23,60 @@ static auto button_name(lua_State* L, uint8_t button_index) -> std::string {
     return "unknown";
 }
 
+void Lou_State::process_event(SDL_Event& e) {
+    auto L = lua_state();
+    switch (e.type) {
+        case SDL_EVENT_QUIT:
+            running = false;
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP:
+            if (e.key.down) {
+                keyboard.pressed.call(L, console, SDL_GetKeyName(e.key.key));
+            } else {
+                keyboard.released.call(L, console, SDL_GetKeyName(e.key.key));
+            }
+        break;
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP:
+            mouse.position = {e.button.x, e.button.y};
+            if (e.button.down) {
+                mouse.pressed.call(
+                    L,
+                    console,
+                    button_name(L, e.button.button),
+                    e.button.x,
+                    e.button.y
+                );
+            } else {
+                mouse.released.call(
+                    L,
+                    console,
+                    button_name(L, e.button.button),
+                    e.button.x,
+                    e.button.y
+                );
+            }
+        break;
+        case SDL_EVENT_MOUSE_MOTION:
+            mouse.position = {e.motion.x, e.motion.y};
+            mouse.moved.call(L, console, e.motion.x, e.motion.y);
+        break;
+    }
+    if (e.type == SDL_EVENT_KEY_DOWN and e.key.key == SDLK_F10 and not e.key.repeat) {
+        trace.toggle_capture(console);
+    }
+    if (e.type == SDL_EVENT_KEY_DOWN and e.key.key == SDLK_F8 and not e.key.repeat) {
+        profiler.toggle_capture(L, console);
+    }
+    if (e.type == SDL_EVENT_KEY_DOWN and e.key.key == SDLK_F7 and not e.key.repeat) {
+        refs.open = not refs.open;
+    }
+    ImGui_ImplSDL3_ProcessEvent(&e);
+    frame.settle_frames = settle_frame_count;
+}
+
 void Lou_State::update() {
+    LOU_TRACE_SCOPE("update");
     if (not destroyed_callbacks.empty()) {
         for (auto& cb : destroyed_callbacks) {
             cb.unbind();
@@ -32,50 +85,57 @@ void Lou_State::update() {
     }
     auto L = lua_state();
     auto& e = cache.event;
-    while (SDL_PollEvent(&e)) {
-        switch (cache.event.type) {
-            case SDL_EVENT_QUIT:
-                running = false;
-            case SDL_EVENT_KEY_DOWN:
-            case SDL_EVENT_KEY_UP:
-                if (e.key.down) {
-                    keyboard.pressed.call(L, console, SDL_GetKeyName(e.key.key));
-                } else {
-                    keyboard.released.call(L, console, SDL_GetKeyName(e.key.key));
-                }
-            break;
-            case SDL_EVENT_MOUSE_BUTTON_DOWN:
-            case SDL_EVENT_MOUSE_BUTTON_UP:
-                if (e.button.down) {
-                    mouse.pressed.call(
-                        L,
-                        console,
-                        button_name(L, e.button.button),
-                        e.button.x,
-                        e.button.y
-                    );
-                } else {
-                    mouse.released.call(
-                        L,
-                        console,
-                        button_name(L, e.button.button),
-                        e.button.x,
-                        e.button.y
-                    );
-                }
-            break;
-            case SDL_EVENT_MOUSE_MOTION:
-                mouse.moved.call(L, console, e.motion.x, e.motion.y);
-            break;
+    const bool replaying = replay.mode == Lou_Replay::Mode::Replay;
+    if (frame.idle_mode and not replaying and not needs_redraw()) {
+        if (SDL_WaitEventTimeout(&e, frame.idle_timeout_ms)) {
+            replay.record_event(e);
+            process_event(e);
+        }
+    }
+    {
+        LOU_TRACE_SCOPE("poll events");
+        while (SDL_PollEvent(&e)) {
+            // live input is ignored while replaying, window and quit events still pass
+            if (replaying and Lou_Replay::is_recordable(e)) continue;
+            replay.record_event(e);
+            process_event(e);
         }
-        ImGui_ImplSDL3_ProcessEvent(&cache.event);
     }
     using namespace std::chrono;
     auto current_frame_start = Clock_t::now();
+    frame.work_start = current_frame_start;
     auto delta_seconds = duration<double>(
         current_frame_start - cache.last_frame_start
     ).count();
     cache.last_frame_start = current_frame_start;
+    if (replaying) {
+        if (not replay.next_frame(delta_seconds)) {
+            running = false;
+            return;
+        }
+        for (auto& recorded : replay.frame_events) process_event(recorded);
+    }
+    replay.end_frame(delta_seconds);
+    entities.update(L, console, delta_seconds);
+    particles.update(delta_seconds);
+    actors.update(L, console);
     on_update.call(L, console, delta_seconds);
+    profiler.end_frame();
+    console.flush_pending();
 }
 
+auto Lou_Trace::toggle_capture(Lou_Console& console) -> void {
+    if (not tracing::enabled()) {
+        tracing::start();
+        console.comment("trace capture started");
+        return;
+    }
+    tracing::stop();
+    open_scopes.clear();
+    auto dumped = tracing::dump(default_file);
+    if (not dumped) {
+        console.error(dumped.error());
+        return;
+    }
+    console.comment(std::format("wrote {} trace events to '{}'", *dumped, default_file));
+}
@@ -3,6 +3,9 @@
 #include <Luau/Compiler.h>
 #include <Luau/CodeGen.h>
 #include <Luau/Require.h>
+#include <Luau/Bytecode.h>
+#include <map>
+#include <mutex>
 #include <ranges>
 #include <algorithm>
 #include <fstream>
@@ -11,7 +14,139 @@
 namespace fs = std::filesystem;
 namespace rngs = std::ranges;
 
-static bool codegen = false;
+// names of every tag, in tag order. used as the userdata type table of both
+// the compiler and codegen, so a type's index is also its value tag.
+static auto userdata_type_names() -> const char* const* {
+    constexpr size_t count = compile_time::count<Tag>();
+    static const auto names = [] {
+        constexpr auto info = compile_time::to_array<Tag>();
+        std::array<std::string, count> strings;
+        for (size_t i{}; i < count; ++i) strings[i] = info[i].name;
+        return strings;
+    }();
+    static const auto pointers = [] {
+        std::array<const char*, count + 1> result{};
+        for (size_t i{}; i < count; ++i) result[i] = names[i].c_str();
+        return result;
+    }();
+    return pointers.data();
+}
+static_assert(compile_time::count<Tag>() <= LBC_TYPE_TAGGED_USERDATA_END - LBC_TYPE_TAGGED_USERDATA_BASE);
+static_assert(compile_time::count<Tag>() < LUA_UTAG_LIMIT / 2, "value and reference tags would overlap");
+
+constexpr auto userdata_type(Tag tag) -> uint8_t {
+    return static_cast<uint8_t>(LBC_TYPE_TAGGED_USERDATA_BASE + static_cast<int>(tag));
+}
+struct Member_Type {
+    Tag type;
+    std::string_view member;
+    uint8_t result;
+};
+// result types the codegen can't infer on its own, the rest stays LBC_TYPE_ANY.
+constexpr std::array accessed_member_types{
+    Member_Type{Tag::Lou_State, "console", userdata_type(Tag::Lou_Console)},
+    Member_Type{Tag::Lou_State, "keyboard", userdata_type(Tag::Lou_Keyboard)},
+    Member_Type{Tag::Lou_State, "mouse", userdata_type(Tag::Lou_Mouse)},
+    Member_Type{Tag::Lou_State, "window", userdata_type(Tag::Lou_Window)},
+    Member_Type{Tag::Lou_State, "renderer", userdata_type(Tag::Lou_Renderer)},
+    Member_Type{Tag::Lou_State, "texture", userdata_type(Tag::Lou_Create_Texture)},
+    Member_Type{Tag::Lou_State, "math", userdata_type(Tag::Lou_Math)},
+    Member_Type{Tag::Lou_State, "trace", userdata_type(Tag::Lou_Trace)},
+    Member_Type{Tag::Lou_State, "entities", userdata_type(Tag::Lou_Entities)},
+    Member_Type{Tag::Lou_State, "particles", userdata_type(Tag::Lou_Particles)},
+    Member_Type{Tag::Lou_State, "actors", userdata_type(Tag::Lou_Actors)},
+    Member_Type{Tag::Lou_State, "jobs", userdata_type(Tag::Lou_Jobs)},
+    Member_Type{Tag::Lou_State, "profiler", userdata_type(Tag::Lou_Profiler)},
+    Member_Type{Tag::Lou_Texture, "size", LBC_TYPE_VECTOR},
+    Member_Type{Tag::Lou_Texture, "color", LBC_TYPE_VECTOR},
+    Member_Type{Tag::Lou_Mouse, "x", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Mouse, "y", LBC_TYPE_NUMBER},
+};
+constexpr std::array namecalled_member_types{
+    Member_Type{Tag::Lou_State, "on_update", userdata_type(Tag::Lou_Callback_Handle)},
+    Member_Type{Tag::Lou_State, "on_render", userdata_type(Tag::Lou_Callback_Handle)},
+    Member_Type{Tag::Lou_State, "dump_refs", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Create_Texture, "from_text", userdata_type(Tag::Lou_Texture)},
+    Member_Type{Tag::Lou_Create_Texture, "from_solid_color", userdata_type(Tag::Lou_Texture)},
+    Member_Type{Tag::Lou_Create_Texture, "load_image", userdata_type(Tag::Lou_Texture)},
+    Member_Type{Tag::Lou_Create_Texture, "draw", userdata_type(Tag::Lou_Texture)},
+    Member_Type{Tag::Lou_Create_Texture, "tilemap", userdata_type(Tag::Lou_Tilemap)},
+    Member_Type{Tag::Lou_Particles, "emitter", userdata_type(Tag::Lou_Emitter)},
+    Member_Type{Tag::Lou_Font, "measure", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Font, "layout", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Actors, "spawn", userdata_type(Tag::Lou_Actor)},
+    Member_Type{Tag::Lou_Actors, "count", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Actor, "alive", LBC_TYPE_BOOLEAN},
+    Member_Type{Tag::Lou_Jobs, "thread_count", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Renderer, "resolution_scale", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Actor, "received", userdata_type(Tag::Lou_Callback_Handle)},
+    Member_Type{Tag::Lou_Emitter, "burst", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Emitter, "count", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Entities, "spawn", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Entities, "count", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Entities, "alive", LBC_TYPE_BOOLEAN},
+    Member_Type{Tag::Lou_Entities, "position", LBC_TYPE_VECTOR},
+    Member_Type{Tag::Lou_Entities, "velocity", LBC_TYPE_VECTOR},
+    Member_Type{Tag::Lou_Entities, "lifetime", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Spatial_Hash, "insert", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Spatial_Hash, "count", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Spatial_Hash, "query_point", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Spatial_Hash, "query_rect", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Spatial_Hash, "pairs", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Tilemap, "get", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Math, "bounds", LBC_TYPE_VECTOR},
+    Member_Type{Tag::Lou_Math, "cull_points", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Math, "cull_rects", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Trace, "dump", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Profiler, "dump", LBC_TYPE_NUMBER},
+    Member_Type{Tag::Lou_Profiler, "samples", LBC_TYPE_NUMBER},
+};
+// call sites the codegen got a result type for, keyed by `Type.member`.
+// actors compile natively on their own threads as well.
+static std::map<std::string, int, std::less<>> typed_results;
+static std::mutex typed_results_mutex;
+template <const auto& Table, char Separator>
+static auto member_bytecode_type(uint8_t type, const char* member, size_t member_length) -> uint8_t {
+    const auto tag = static_cast<Tag>(type - LBC_TYPE_TAGGED_USERDATA_BASE);
+    const std::string_view name{member, member_length};
+    auto found = rngs::find_if(Table, [&](const Member_Type& e) {
+        return e.type == tag and e.member == name;
+    });
+    if (found == rngs::end(Table)) return LBC_TYPE_ANY;
+    auto key = std::format("{}{}{}", compile_time::enum_item<Tag>(static_cast<int>(tag)).name, Separator, name);
+    std::lock_guard lock{typed_results_mutex};
+    ++typed_results[key];
+    return found->result;
+}
+static auto remap_userdata_type(void* context, const char* name, size_t length) -> uint8_t {
+    const std::string_view type{name, length};
+    auto names = static_cast<const char* const*>(context);
+    for (uint8_t i{}; names[i]; ++i) {
+        if (type == names[i]) return i;
+    }
+    return 0xff;
+}
+
+auto compile_native(lua_State* L, int idx) -> void {
+    if (not Lou_State::native_codegen) return;
+    LOU_TRACE_SCOPE("native compile");
+    Luau::CodeGen::CompilationOptions options;
+    options.userdataTypes = userdata_type_names();
+    options.hooks.userdataAccessBytecodeType = member_bytecode_type<accessed_member_types, '.'>;
+    options.hooks.userdataNamecallBytecodeType = member_bytecode_type<namecalled_member_types, ':'>;
+    Luau::CodeGen::compile(L, idx, options);
+}
+
+auto typed_results_report() -> std::string {
+    std::lock_guard lock{typed_results_mutex};
+    if (typed_results.empty()) return "no userdata call site got a typed result";
+    std::string report;
+    for (const auto& [site, count] : typed_results) {
+        std::format_to(std::back_inserter(report), "{:>6}  {}\n", count, site);
+    }
+    report.pop_back();
+    return report;
+}
 
 auto copts() -> Luau::CompileOptions {
     Luau::CompileOptions result = {};
@@ -19,6 +154,12 @@ auto copts() -> Luau::CompileOptions {
     result.debugLevel = 3;
     result.typeInfoLevel = 1;
     result.coverageLevel = 2;
+    // the compiler accepts a single vector constructor. `rect` is the one
+    // called the most in draw code and it matches the builtin exactly:
+    // constant arguments fold into a vector constant and the rest turn into
+    // a fastcall that skips the global lookup.
+    if (Lou_State::fold_vector_constructors) result.vectorCtor = "rect";
+    result.userdataTypes = userdata_type_names();
     return result;
 }
 
@@ -140,17 +281,26 @@ lua_getfield(L, LUA_REGISTRYINDEX, "_MODULES");
     luaL_sandboxthread(ML);
 
     // now we can compile & run module on the new thread
-    std::string bytecode = Luau::compile(resolvedRequire.sourceCode, copts());
-    if (luau_load(ML, resolvedRequire.identifier.c_str(), bytecode.data(), bytecode.size(), 0) == 0)
+    std::string bytecode;
+    int load_status;
     {
-        if (codegen)
+        LOU_TRACE_SCOPE("require compile");
+        bytecode = Luau::compile(resolvedRequire.sourceCode, copts());
+    }
+    {
+        LOU_TRACE_SCOPE("require load");
+        load_status = luau_load(ML, resolvedRequire.identifier.c_str(), bytecode.data(), bytecode.size(), 0);
+    }
+    if (load_status == 0)
+    {
+        compile_native(ML, -1);
+
+        int status;
         {
-            Luau::CodeGen::CompilationOptions nativeOptions;
-            Luau::CodeGen::compile(ML, -1, nativeOptions);
+            LOU_TRACE_SCOPE("require run");
+            status = lua_resume(ML, L, 0);
         }
 
-        int status = lua_resume(ML, L, 0);
-
         if (status == 0)
         {
             if (lua_gettop(ML) == 0)
@@ -248,7 +398,7 @@ static auto load_script(lua_State* L, const fs::path& path) -> std::expected<dec
 }
 static auto user_atom(const char* str, size_t len) -> int16_t {
     std::string_view namecall{str, len};
-    logger.log("new atom entry {}", namecall);
+    logger.debug("new atom entry {}", namecall);
     constexpr std::array info = compile_time::to_array<Namecall_Atom>();
     auto found = rngs::find_if(info, [&namecall](decltype(info[0])& e) {
         return e.name == namecall;
@@ -268,22 +418,18 @@ static auto init_tagged(lua_State* L) -> void {
     auto lightuserdataname = std::format("(light){}", compile_time::enum_item<Val>().name);
     lua_setlightuserdataname(L, int(Val), lightuserdataname.c_str());
 }
-static auto set_up_print_and_warm(lua_State* L, Lou_Console& console) -> void {
+static auto set_up_print_and_warm(lua_State* L) -> void {
     auto print = [](lua_State* L) -> int {
-        auto& console = to_tagged<Tag::Lou_Console>(L, lua_upvalueindex(1));
-        console.comment(lua::tuple_tostring(L));
+        Lou_State::from(L).console.comment(lua::tuple_tostring(L));
         return 0;
     };
-    push_tagged(L, console);
-    lua_pushcclosure(L, print, "print", 1);
+    lua_pushcfunction(L, print, "print");
     lua_setglobal(L, "print");
     auto warn = [](lua_State* L) -> int {
-        auto& console = to_tagged<Tag::Lou_Console>(L, lua_upvalueindex(1));
-        console.warn(lua::tuple_tostring(L));
+        Lou_State::from(L).console.warn(lua::tuple_tostring(L));
         return 0;
     };
-    push_tagged(L, console);
-    lua_pushcclosure(L, warn, "warn", 1);
+    lua_pushcfunction(L, warn, "warn");
     lua_setglobal(L, "warn");
 }
 
@@ -357,11 +503,75 @@ static void register_vector_aliases(lua_State* L) {
     lua_pop(L, 1);
 }
 
+static auto counting_alloc(void* ud, void* ptr, size_t osize, size_t nsize) -> void* {
+    auto& state = *static_cast<Lou_State*>(ud);
+    if (nsize == 0) {
+        if (ptr) ++state.memory.frees;
+        std::free(ptr);
+        return nullptr;
+    }
+    if (not ptr) ++state.memory.allocations;
+    return std::realloc(ptr, nsize);
+}
+
+auto new_worker_luau(Lou_Console& console, void* userdata, const luaL_Reg* globals) -> C_Owner_t<lua_State> {
+    C_Owner_t<lua_State> owner{luaL_newstate(), lua::close};
+    auto L = owner.get();
+    lua_callbacks(L)->userdata = userdata;
+    if (Lou_State::native_codegen) {
+        Luau::CodeGen::create(L);
+        Luau::CodeGen::setUserdataRemapper(
+            L,
+            const_cast<const char**>(userdata_type_names()),
+            remap_userdata_type
+        );
+    }
+    luaL_openlibs(L);
+    static const luaL_Reg funcs[] = {
+        {"require", lua_require},
+        {"collectgarbage", lua_collectgarbage},
+        {NULL, NULL},
+    };
+    lua_pushvalue(L, LUA_GLOBALSINDEX);
+    luaL_register(L, nullptr, funcs);
+    luaL_register(L, nullptr, globals);
+    lua_pop(L, 1);
+    register_vector_aliases(L);
+    // the console is safe to print to from any thread
+    auto print = [](lua_State* L) -> int {
+        auto& console = *static_cast<Lou_Console*>(lua_tolightuserdata(L, lua_upvalueindex(1)));
+        console.comment(lua::tuple_tostring(L));
+        return 0;
+    };
+    lua_pushlightuserdata(L, &console);
+    lua_pushcclosure(L, print, "print", 1);
+    lua_setglobal(L, "print");
+    auto warn = [](lua_State* L) -> int {
+        auto& console = *static_cast<Lou_Console*>(lua_tolightuserdata(L, lua_upvalueindex(1)));
+        console.warn(lua::tuple_tostring(L));
+        return 0;
+    };
+    lua_pushlightuserdata(L, &console);
+    lua_pushcclosure(L, warn, "warn", 1);
+    lua_setglobal(L, "warn");
+
+    luaL_sandbox(L);
+    return owner;
+}
+
 auto Lou_State::init_luau() -> void {
-    owning.luau.reset(luaL_newstate());
+    owning.luau.reset(lua_newstate(counting_alloc, this));
     auto L = lua_state();
+    lua_callbacks(L)->userdata = this;
     lua_callbacks(L)->useratom = user_atom;
-    if (codegen) Luau::CodeGen::create(L);
+    if (native_codegen) {
+        Luau::CodeGen::create(L);
+        Luau::CodeGen::setUserdataRemapper(
+            L,
+            const_cast<const char**>(userdata_type_names()),
+            remap_userdata_type
+        );
+    }
     luaL_openlibs(L);
     static const luaL_Reg funcs[] = {
         {"loadstring", lua_loadstring},
@@ -382,16 +592,30 @@ auto Lou_State::init_luau() -> void {
     init_tagged<Lou_Texture>(L);
     init_tagged<Lou_Create_Texture>(L);
     init_tagged<Lou_Callback_Handle>(L);
+    init_tagged<Lou_Math>(L);
+    init_tagged<Lou_Trace>(L);
+    init_tagged<Lou_Entities>(L);
+    init_tagged<Lou_Particles>(L);
+    init_tagged<Lou_Emitter>(L);
+    init_tagged<Lou_Tilemap>(L);
+    init_tagged<Lou_Spatial_Hash>(L);
+    init_tagged<Lou_Actors>(L);
+    init_tagged<Lou_Actor>(L);
+    init_tagged<Lou_Jobs>(L);
+    init_tagged<Lou_Profiler>(L);
 
     lua_pushvalue(L, LUA_GLOBALSINDEX);
     luaL_register(L, nullptr, funcs);
     lua_pop(L, 1);
     register_vector_aliases(L);
+    bind_subsystems(L);
     push_tagged<Lou_State, false>(L, *this);
     lua_setglobal(L, global_name);
     Lou_Font::push_constructor(L);
     lua_setglobal(L, "Font");
-    set_up_print_and_warm(L, console);
+    Lou_Spatial_Hash::push_constructor(L);
+    lua_setglobal(L, "Spatial_Hash");
+    set_up_print_and_warm(L);
 
     luaL_sandbox(L);
 }
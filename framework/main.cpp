@@ -0,0 +1,48 @@
+#include <SDL3/SDL_main.h>
+#include "Lou.hpp"
+using Init_Info = Lou_State::Init_Info;
+
+static auto parse_arguments(int argc, char** argv) -> Init_Info {
+    Init_Info info{
+        .title{"test"},
+        .width = 1920,
+        .height = 1080,
+        .flags = SDL_WINDOW_RESIZABLE,
+        .script_entry_point = "init.luau",
+    };
+    for (int i{1}; i < argc; ++i) {
+        std::string_view arg{argv[i]};
+        const bool has_value = i + 1 < argc;
+        if (arg == "--record" and has_value) {
+            info.record_file = argv[++i];
+        } else if (arg == "--replay" and has_value) {
+            info.replay_file = argv[++i];
+        } else if (arg == "--replay-delta" and has_value) {
+            info.replay_delta = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--idle") {
+            info.idle_mode = true;
+        } else if (arg == "--native") {
+            info.native_codegen = true;
+        } else {
+            info.script_entry_point = arg;
+        }
+    }
+    return info;
+}
+
+auto main(int argc, char** argv) -> int {
+    Lou_State state;
+    state.init(parse_arguments(argc, argv));
+    const bool replaying = state.replay.mode == Lou_Replay::Mode::Replay;
+    while(state.running) {
+        state.update();
+        state.render();
+        if (not replaying) SDL_Delay(16);
+    }
+    if (state.replay.mode != Lou_Replay::Mode::Off) {
+        auto report = state.frame_time_report();
+        logger.info("{}", report);
+        std::println("{}", report);
+    }
+    return 0;
+}
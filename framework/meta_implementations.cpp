@@ -39,6 +39,7 @@ constexpr void generic_destructor(lua_State* L, void* userdata) {
 }
 template <Tag Val, lua_Destructor Destructor = generic_destructor<Type_For<Val>>>
 constexpr void set_destructor(lua_State* L) {
+    static_assert(not is_handle_type<Val>, "handle types do not own what they point to");
     lua_setuserdatadtor(L, static_cast<int>(Val), Destructor);
 }
 template <Tag Val>
@@ -68,12 +69,6 @@ constexpr auto basic_tostring(auto&&...args) -> std::string {
     return str;
 }
 
-static auto global_state(lua_State* L) -> Lou_State& {
-    lua_getglobal(L, Lou_State::global_name);
-    auto& state = to_tagged<State>(L, -1);
-    lua_pop(L, 1);
-    return state;
-}
 constexpr SDL_BlendMode string_to_blend_mode(const std::string_view str) {
     if (str == "none") return SDL_BLENDMODE_NONE;
     else if (str == "add") return SDL_BLENDMODE_ADD;
@@ -97,19 +92,65 @@ constexpr const char* blend_mode_to_string(SDL_BlendMode bm) {
     }
 }
 // Font meta implementation
+static auto font_layout(lua_State* L, Lou_Font& font, int wrap_width) -> Lou_Fonts::Layout& {
+    auto& state = Lou_State::from(L);
+    auto text = lua::check<std::string_view>(L, 2);
+    auto layout = state.fonts.layout(state.renderer.get_text_engine(), font.ptr, text, wrap_width);
+    if (not layout) lua::error(L, layout.error());
+    return **layout;
+}
+static auto check_wrap_width(lua_State* L, int idx) -> int {
+    const int wrap_width = luaL_optinteger(L, idx, 0);
+    if (wrap_width < 0) lua::arg_error(L, idx, "wrap width can't be negative");
+    return wrap_width;
+}
+static auto font_namecall(lua_State* L) -> int {
+    auto& self = to_tagged<Font>(L, 1);
+    auto [atom, name] = lua::namecall_atom<Namecall_Atom>(L);
+    switch (atom) {
+        case Namecall_Atom::measure: {
+            auto& layout = font_layout(L, self, 0);
+            return lua::values(L, static_cast<double>(layout.width), static_cast<double>(layout.height));
+        }
+        case Namecall_Atom::layout: {
+            auto& layout = font_layout(L, self, check_wrap_width(L, 3));
+            return lua::values(L,
+                static_cast<double>(layout.width),
+                static_cast<double>(layout.height),
+                static_cast<double>(layout.ptr->num_lines)
+            );
+        }
+        case Namecall_Atom::draw: {
+            auto position = as_point(lua::check<Vector_t>(L, 3));
+            auto& layout = font_layout(L, self, check_wrap_width(L, 4));
+            auto color = lua_isnoneornil(L, 5) ? SDL_FColor{1, 1, 1, 1} : as_color(lua::check<Vector_t>(L, 5));
+            auto& renderer = Lou_State::from(L).renderer;
+            check_sdl(L, renderer.flush());
+            check_sdl(L, TTF_SetTextColorFloat(layout.ptr.get(), color.r, color.g, color.b, color.a));
+            check_sdl(L, TTF_DrawRendererText(layout.ptr.get(), position.x, position.y));
+            return None;
+        }
+        default: break;
+    }
+    err_invalid_method<Font>(L, atom);
+}
 void Lou_Font::push_metatable(lua_State *L) {
     if (new_metatable<Font>(L)) {
         set_destructor<Font>(L);
+        const luaL_Reg meta[] = {
+            {"__namecall", font_namecall},
+            {nullptr, nullptr}
+        };
+        luaL_register(L, nullptr, meta);
         set_type_metamethod<Font>(L);
     }
 }
 void Lou_Font::push_constructor(lua_State* L) {
     auto constructor = [](lua_State* L) -> int {
         auto [file, size] = lua::check_args<const char*, float>(L);
-        Lou_Font font;
-        font.ptr.reset(TTF_OpenFont(file, size));
-        check_sdl(L, font.ptr != nullptr);
-        make_tagged<Font>(L, std::move(font));
+        auto font = Lou_State::from(L).fonts.open(file, size);
+        if (not font) lua::error(L, font.error());
+        make_tagged<Font>(L, Lou_Font{.ptr = std::move(*font)});
         return 1;
     };
     lua_pushcfunction(L, constructor, "Font");
@@ -120,7 +161,7 @@ static auto callback_handle_namecall(lua_State* L) -> int {
     switch (atom) {
         case Namecall_Atom::destroy: {
             if (not self.callback) return None;
-            global_state(L).destroyed_callbacks.push_back(self);
+            Lou_State::from(L).destroyed_callbacks.push_back(self);
             self.callback = nullptr;
             return None;
         }
@@ -138,78 +179,114 @@ void Lou_Callback_Handle::push_metatable(lua_State *L) {
 // Texture meta implementation
 static auto texture_index(lua_State* L) -> int {
     auto& self = to_tagged<Texture>(L, 1);
-    auto texture = self.get();
-    auto initial = lua::check<char>(L, 2);
-    switch (initial) {
-        case 's': {
-            float w, h;
-            check_sdl(L, SDL_GetTextureSize(self.get(), &w, &h));
-            lua_pushvector(L, w, h, 0, 0);
+    auto [atom, key] = lua::index_atom<Namecall_Atom>(L, 2);
+    switch (atom) {
+        case Namecall_Atom::size:
+            lua_pushvector(L, self.size.x, self.size.y, 0, 0);
             return Value;
-        }
-        case 'c': {
-            std::array color{0.f, 0.f, 0.f, 1.f}; 
-            check_sdl(L, SDL_GetTextureColorModFloat(self.get(), &color[0], &color[1], &color[2]));
-            check_sdl(L, SDL_GetTextureAlphaModFloat(texture, &color[3]));
-            lua::push(L, color);
+        case Namecall_Atom::color:
+            lua::push(L, std::array{self.color.r, self.color.g, self.color.b, self.color.a});
             return Value;
-        }
+        default: break;
     }
     lua::arg_error(L, 2, "invalid index");
 }
 static auto texture_newindex(lua_State* L) -> int {
     auto& self = to_tagged<Texture>(L, 1);
     auto texture = self.get();
-    auto initial = lua::check<char>(L, 2);
-    switch (initial) {
-        case 's':
+    auto [atom, key] = lua::index_atom<Namecall_Atom>(L, 2);
+    switch (atom) {
+        case Namecall_Atom::size:
             lua::error(L, "field is readonly");
-        case 'c': {
+        case Namecall_Atom::color: {
             auto col = as_color(lua::check<Vector_t>(L, 3));
             check_sdl(L, SDL_SetTextureColorModFloat(texture, col.r, col.g, col.b));
             check_sdl(L, SDL_SetTextureAlphaModFloat(texture, col.a));
+            self.color = col;
             return None;
         }
+        default: break;
     }
     lua::arg_error(L, 2, "invalid index");
 
 }
+static void redraw_if_dirty(lua_State* L, Lou_Texture& texture) {
+    auto drawn = texture.redraw_if_dirty(L);
+    if (!drawn) lua::error(L, drawn.error());
+}
+static auto opt_flip_mode(lua_State* L, int idx) -> SDL_FlipMode {
+    std::string_view flip = luaL_optstring(L, idx, "none");
+    if (flip == "none") return SDL_FLIP_NONE;
+    else if (flip == "horizontal") return SDL_FLIP_HORIZONTAL;
+    else if (flip == "vertical") return SDL_FLIP_VERTICAL;
+    else if (flip == "both") return static_cast<SDL_FlipMode>(SDL_FLIP_HORIZONTAL | SDL_FLIP_VERTICAL);
+    lua::arg_error(L, idx, "invalid flip mode '{}'", flip);
+}
+static auto draw_sprite(lua_State* L, Lou_Texture& texture, const Lou_Renderer::Sprite& sprite) -> int {
+    redraw_if_dirty(L, texture);
+    check_sdl(L, Lou_State::from(L).renderer.draw_sprite(texture, sprite));
+    return None;
+}
 static auto texture_namecall(lua_State* L) -> int {
     auto& self = to_tagged<Texture>(L, 1);
-    auto renderer = SDL_GetRendererFromTexture(self.get());
-    if (!renderer) lua::error(L, SDL_GetError());
     auto [atom, name] = lua::namecall_atom<Namecall_Atom>(L);
     switch (atom) {
+        case Namecall_Atom::invalidate: {
+            self.dirty = true;
+            return None;
+        }
+        case Namecall_Atom::redraw: {
+            if (not self.render_target) lua::error(L, "texture is not a render target");
+            auto drawn = self.redraw(L);
+            if (!drawn) lua::error(L, drawn.error());
+            return None;
+        }
         case Namecall_Atom::render: {
+            Lou_Renderer::Sprite sprite{.source = self.source_rect()};
             if (lua_isnumber(L, 2)) {
-                auto rect = self.source_rect();
-                if (!rect) lua::error(L, rect.error());
                 auto [x, y] = lua::check_args<float, float>(L, 2);
-                rect->x = x;
-                rect->y = y;
-                rect->w = static_cast<float>(luaL_optnumber(L, 4, rect->w));
-                rect->h = static_cast<float>(luaL_optnumber(L, 5, rect->h));
-                check_sdl(L, SDL_RenderTexture(renderer, self.get(), nullptr, &rect.value()));
-                return None;
-            } else if (lua_isvector(L, 2)) {
-                auto [dst, angle] = lua::check_args<lua::Vector_t, double>(L, 2);
-                SDL_FRect dest{dst[0], dst[1], dst[2], dst[3]};
-                check_sdl(L, SDL_RenderTexture(renderer, self.get(), nullptr, &dest));
-                return None;
+                sprite.destination = {
+                    x,
+                    y,
+                    static_cast<float>(luaL_optnumber(L, 4, sprite.source.w)),
+                    static_cast<float>(luaL_optnumber(L, 5, sprite.source.h)),
+                };
+            } else {
+                sprite.destination = as_rect(lua::check<Vector_t>(L, 2));
+                sprite.angle = luaL_optnumber(L, 3, 0);
+                if (not lua_isnoneornil(L, 4)) sprite.source = as_rect(lua::check<Vector_t>(L, 4));
+                sprite.flip = opt_flip_mode(L, 5);
             }
+            return draw_sprite(L, self, sprite);
         }
         case Namecall_Atom::render_rotated: {
-            return None;
+            auto [dst, angle, pivot] = lua::check_args<Vector_t, double, Vector_t>(L, 2);
+            Lou_Renderer::Sprite sprite{
+                .source = self.source_rect(),
+                .destination = as_rect(dst),
+                .angle = angle,
+                .pivot = as_point(pivot),
+                .flip = opt_flip_mode(L, 5),
+            };
+            if (not lua_isnoneornil(L, 6)) sprite.source = as_rect(lua::check<Vector_t>(L, 6));
+            return draw_sprite(L, self, sprite);
         }
         default: break;
     }
     err_invalid_method<Texture>(L, atom);
 }
+// pending sprites of a texture have to be submitted before it gets destroyed.
+static void texture_destructor(lua_State* L, void* userdata) {
+    auto texture = static_cast<Lou_Texture*>(userdata);
+    Lou_State::from(L).renderer.release(texture->get());
+    texture->~Lou_Texture();
+}
 void Lou_Texture::push_metatable(lua_State *L) {
     if (new_metatable<Texture>(L)) {
-        set_destructor<Texture>(L);
+        set_destructor<Texture, texture_destructor>(L);
         const luaL_Reg meta[] = {
             {"__index", texture_index},
+            {"__newindex", texture_newindex},
             {"__namecall", texture_namecall},
             {nullptr, nullptr}
         };
@@ -237,6 +314,35 @@ static auto create_texture_namecall(lua_State* L) -> int {
             make_tagged<Texture>(L, std::move(texture.value()));
             return Value;
         }
+        case Namecall_Atom::from_solid_color: {
+            auto color = as_color(lua::check<Vector_t>(L, 2));
+            const int w = luaL_optinteger(L, 3, 1);
+            const int h = luaL_optinteger(L, 4, 1);
+            auto texture = self.solid_color(color, w, h);
+            if (!texture) lua::error(L, texture.error());
+            make_tagged<Texture>(L, std::move(texture.value()));
+            return Value;
+        }
+        case Namecall_Atom::draw: {
+            luaL_checktype(L, 2, LUA_TFUNCTION);
+            auto [w, h] = lua::check_args<int, int>(L, 3);
+            auto texture = self.render_target(w, h);
+            if (!texture) lua::error(L, texture.error());
+            auto& target = make_tagged<Texture>(L, std::move(texture.value()));
+            target.set_draw_fn(L, -1, 2);
+            auto drawn = target.redraw(L);
+            if (!drawn) lua::error(L, drawn.error());
+            return Value;
+        }
+        case Namecall_Atom::tilemap: {
+            auto& tileset = to_tagged<Texture>(L, 2);
+            auto tile_size = as_point(lua::check<Vector_t>(L, 3));
+            auto [w, h] = lua::check_args<int, int>(L, 4);
+            if (tile_size.x < 1 or tile_size.y < 1) lua::arg_error(L, 3, "tile size must be at least 1");
+            if (w < 1 or h < 1) lua::arg_error(L, 4, "map size must be at least 1");
+            make_tagged<Tag::Lou_Tilemap>(L, tileset, lua::Ref{L, 2}, tile_size, w, h);
+            return Value;
+        }
         default: break;
     }
     err_invalid_method<Tag::Lou_Texture>(L, atom);
@@ -339,20 +445,24 @@ static auto renderer_namecall(lua_State* L) -> int {
     switch (static_cast<Namecall_Atom>(atom)) {
         case Namecall_Atom::draw_rect: {
             auto rect = as_rect(lua::check<Vector_t>(L, 2));
+            check_sdl(L, renderer.flush());
             check_sdl(L, SDL_RenderRect(ptr, &rect));
             return None;
         }
         case Namecall_Atom::fill_rect: {
             auto rect = as_rect(lua::check<Vector_t>(L, 2));
+            check_sdl(L, renderer.flush());
             check_sdl(L, SDL_RenderFillRect(ptr, &rect));
             return None;
         }
         case Namecall_Atom::draw_point: {
             auto [x, y] = lua::check_args<float, float>(L, 2);
+            check_sdl(L, renderer.flush());
             check_sdl(L, SDL_RenderPoint(ptr, x, y));
             return None;
         }
         case Namecall_Atom::clear: {
+            check_sdl(L, renderer.flush());
             check_sdl(L, SDL_RenderClear(ptr));
             return None;
         }
@@ -372,18 +482,63 @@ static auto renderer_namecall(lua_State* L) -> int {
         }
         case Namecall_Atom::render_texture: {
             auto& texture = to_tagged<Texture>(L, 2);
+            Lou_Renderer::Sprite sprite{.source = texture.source_rect()};
             if (lua_isnumber(L, 3)) {
                 auto [x, y] = lua::check_args<float, float>(L, 3);
-                float w, h;
-                check_sdl(L, SDL_GetTextureSize(texture.ptr.get(), &w, &h));
-                SDL_FRect rect{x, y, w, h};
-                check_sdl(L, SDL_RenderTexture(ptr, texture.ptr.get(), nullptr, &rect));
-                return None;
+                sprite.destination = {x, y, texture.size.x, texture.size.y};
             } else {
-                auto rect = as_rect(lua::check<Vector_t>(L, 3));
-                check_sdl(L, SDL_RenderTexture(ptr, texture.ptr.get(), nullptr, &rect));
-                return None;
+                sprite.destination = as_rect(lua::check<Vector_t>(L, 3));
             }
+            return draw_sprite(L, texture, sprite);
+        }
+        case Namecall_Atom::dynamic_resolution: {
+            auto& res = renderer.resolution;
+            // validated before anything is assigned, a rejected call changes nothing
+            const bool enabled = lua::check<bool>(L, 2);
+            const auto budget_ms = static_cast<float>(luaL_optnumber(L, 3, res.budget_ms));
+            const auto min_scale = static_cast<float>(luaL_optnumber(L, 4, res.min_scale));
+            const auto max_scale = static_cast<float>(luaL_optnumber(L, 5, res.max_scale));
+            if (not (budget_ms > 0)) lua::arg_error(L, 3, "budget must be greater than 0");
+            if (not (min_scale > 0 and min_scale <= max_scale and max_scale <= 1)) {
+                lua::arg_error(L, 4, "scales must satisfy 0 < min <= max <= 1");
+            }
+            res.enabled = enabled;
+            res.budget_ms = budget_ms;
+            res.min_scale = min_scale;
+            res.max_scale = max_scale;
+            res.scale = std::clamp(res.scale, res.min_scale, res.max_scale);
+            res.average_ms = 0;
+            res.cooldown = 0;
+            return None;
+        }
+        case Namecall_Atom::resolution_scale: {
+            const auto& res = renderer.resolution;
+            return lua::values(L, res.scale, res.average_ms, res.budget_ms, res.enabled);
+        }
+        case Namecall_Atom::capture:
+            renderer.capture.request(luaL_optstring(L, 2, Lou_Capture::default_file));
+            Lou_State::from(L).frame.redraw_requested = true;
+            return None;
+        case Namecall_Atom::start_capture: {
+            const std::string_view format = luaL_optstring(L, 3, "png");
+            if (format != "png" and format != "raw") lua::arg_error(L, 3, "format must be 'png' or 'raw'");
+            auto started = renderer.capture.start(
+                luaL_checkstring(L, 2),
+                format == "png" ? Lou_Capture::Format::Png : Lou_Capture::Format::Raw
+            );
+            if (not started) lua::error(L, started.error());
+            return None;
+        }
+        case Namecall_Atom::stop_capture:
+            renderer.capture.stop();
+            return None;
+        case Namecall_Atom::capture_stats: {
+            auto stats = renderer.capture.stats();
+            return lua::values(L,
+                static_cast<double>(stats.written),
+                static_cast<double>(stats.dropped),
+                static_cast<double>(stats.failed)
+            );
         }
         default: break;
     }
@@ -399,18 +554,17 @@ void Lou_Renderer::push_metatable(lua_State *L) {
 // Lou_Mouse meta implementation
 static auto mouse_index(lua_State* L) -> int {
     auto& self = to_tagged<Mouse>(L, 1);
-    std::string_view key = luaL_checkstring(L, 2);
+    auto [atom, key] = lua::index_atom<Namecall_Atom>(L, 2);
     // gotta watch out with this. if accessed directly with `lou.mouse.x`
     // it returns the a constant initial value because of sandboxing.
     // easy workaround is first putting `lou.mouse` in a local variable,
     // but this might be quite confusing and cause complicated bugs for
     // the ones who are unaware of this fact. might make these methods
     // specifically for avoiding this confusion.
-    float x, y;
-    SDL_GetMouseState(&x, &y);
-    switch (key.at(0)) {
-        case 'x': return lua::values(L, x);
-        case 'y': return lua::values(L, y);
+    switch (atom) {
+        case Namecall_Atom::x: return lua::values(L, self.position.x);
+        case Namecall_Atom::y: return lua::values(L, self.position.y);
+        default: break;
     }
     lua::arg_error(L, 2, "invalid field '{}'", key);
 }
@@ -427,11 +581,8 @@ static auto mouse_namecall(lua_State* L) -> int {
         case Namecall_Atom::moved:
             return callback_handle(L, self.moved);
         return None;
-        case Namecall_Atom::position: {
-            float x, y;
-            SDL_GetMouseState(&x, &y);
-            return lua::values(L, x, y);
-        }
+        case Namecall_Atom::position:
+            return lua::values(L, self.position.x, self.position.y);
         default:
             err_invalid_method<Mouse>(L, atom);
         break;
@@ -512,32 +663,585 @@ auto Lou_Console::push_metatable(lua_State* L) -> void {
         set_type_metamethod<Console>(L);
     }
 }
+// Lou_Math meta implementation
+static auto opt_point(lua_State* L, int idx) -> SDL_FPoint {
+    if (lua_isnoneornil(L, idx)) return {0, 0};
+    return as_point(lua::check<Vector_t>(L, idx));
+}
+static auto math_namecall(lua_State* L) -> int {
+    auto [atom, name] = lua::namecall_atom<Namecall_Atom>(L);
+    switch (atom) {
+        case Namecall_Atom::transform: {
+            auto points = Lou_Math::to_points(L, 2);
+            Lou_Math::transform(points, lua::check<Vector_t>(L, 3), opt_point(L, 4));
+            return None;
+        }
+        case Namecall_Atom::translate: {
+            auto points = Lou_Math::to_points(L, 2);
+            Lou_Math::translate(points, as_point(lua::check<Vector_t>(L, 3)));
+            return None;
+        }
+        case Namecall_Atom::scale: {
+            auto points = Lou_Math::to_points(L, 2);
+            Lou_Math::scale(points, as_point(lua::check<Vector_t>(L, 3)), opt_point(L, 4));
+            return None;
+        }
+        case Namecall_Atom::rotate: {
+            auto points = Lou_Math::to_points(L, 2);
+            Lou_Math::rotate(points, lua::check<float>(L, 3), opt_point(L, 4));
+            return None;
+        }
+        case Namecall_Atom::bounds: {
+            auto r = Lou_Math::bounds(Lou_Math::to_points(L, 2));
+            lua_pushvector(L, r.x, r.y, r.w, r.h);
+            return Value;
+        }
+        case Namecall_Atom::cull_points: {
+            auto points = Lou_Math::to_points(L, 2);
+            auto view = as_rect(lua::check<Vector_t>(L, 3));
+            auto out = Lou_Math::to_points(L, 4);
+            return lua::values(L, static_cast<int>(Lou_Math::cull_points(points, view, out)));
+        }
+        case Namecall_Atom::cull_rects: {
+            size_t rects_len{}, out_len{};
+            auto rects = static_cast<const float*>(luaL_checkbuffer(L, 2, &rects_len));
+            auto view = as_rect(lua::check<Vector_t>(L, 3));
+            auto out = static_cast<uint32_t*>(luaL_checkbuffer(L, 4, &out_len));
+            const auto count = Lou_Math::cull_rects(
+                {rects, rects_len / sizeof(float)},
+                view,
+                {out, out_len / sizeof(uint32_t)}
+            );
+            return lua::values(L, static_cast<int>(count));
+        }
+        default: break;
+    }
+    err_invalid_method<Tag::Lou_Math>(L, atom);
+}
+void Lou_Math::push_metatable(lua_State* L) {
+    constexpr luaL_Reg meta[] = {
+        {"__namecall", math_namecall},
+        {nullptr, nullptr}
+    };
+    basic_push_metatable<Tag::Lou_Math>(L, meta);
+}
+// Lou_Trace meta implementation
+static auto trace_namecall(lua_State* L) -> int {
+    auto& self = to_tagged<Tag::Lou_Trace>(L, 1);
+    auto [atom, name] = lua::namecall_atom<Namecall_Atom>(L);
+    switch (atom) {
+        case Namecall_Atom::begin:
+            self.begin(lua::check<std::string_view>(L, 2));
+            return None;
+        case Namecall_Atom::finish:
+            self.finish();
+            return None;
+        case Namecall_Atom::start:
+            tracing::start();
+            return None;
+        case Namecall_Atom::stop:
+            tracing::stop();
+            self.open_scopes.clear();
+            return None;
+        case Namecall_Atom::dump: {
+            self.open_scopes.clear();
+            auto dumped = tracing::dump(luaL_optstring(L, 2, Lou_Trace::default_file));
+            if (!dumped) lua::error(L, dumped.error());
+            return lua::values(L, static_cast<int>(*dumped));
+        }
+        default: break;
+    }
+    err_invalid_method<Tag::Lou_Trace>(L, atom);
+}
+void Lou_Trace::push_metatable(lua_State* L) {
+    constexpr luaL_Reg meta[] = {
+        {"__namecall", trace_namecall},
+        {nullptr, nullptr}
+    };
+    basic_push_metatable<Tag::Lou_Trace>(L, meta);
+}
+// Lou_Profiler meta implementation
+static auto profiler_namecall(lua_State* L) -> int {
+    auto& self = to_tagged<Tag::Lou_Profiler>(L, 1);
+    auto [atom, name] = lua::namecall_atom<Namecall_Atom>(L);
+    switch (atom) {
+        case Namecall_Atom::start: {
+            const auto interval_us = luaL_optinteger(L, 2, Lou_Profiler::default_interval.count());
+            if (interval_us < 100) lua::arg_error(L, 2, "interval must be at least 100 microseconds");
+            self.start(lua_mainthread(L), std::chrono::microseconds(interval_us));
+            return None;
+        }
+        case Namecall_Atom::stop:
+            self.stop(lua_mainthread(L));
+            return None;
+        case Namecall_Atom::samples:
+            return lua::values(L, static_cast<double>(self.samples));
+        case Namecall_Atom::dump: {
+            auto dumped = self.dump(luaL_optstring(L, 2, Lou_Profiler::default_file));
+            if (not dumped) lua::error(L, dumped.error());
+            return lua::values(L, static_cast<double>(*dumped));
+        }
+        default: break;
+    }
+    err_invalid_method<Tag::Lou_Profiler>(L, atom);
+}
+void Lou_Profiler::push_metatable(lua_State* L) {
+    constexpr luaL_Reg meta[] = {
+        {"__namecall", profiler_namecall},
+        {nullptr, nullptr}
+    };
+    basic_push_metatable<Tag::Lou_Profiler>(L, meta);
+}
+// Lou_Entities meta implementation
+static auto check_entity(lua_State* L, Lou_Entities& self, int idx) -> size_t {
+    const auto id = static_cast<Lou_Entities::Id>(luaL_checkunsigned(L, idx));
+    auto index = self.find(id);
+    if (not index) lua::arg_error(L, idx, "entity {} does not exist", id);
+    return *index;
+}
+static auto entities_namecall(lua_State* L) -> int {
+    auto& self = to_tagged<Tag::Lou_Entities>(L, 1);
+    auto [atom, name] = lua::namecall_atom<Namecall_Atom>(L);
+    switch (atom) {
+        case Namecall_Atom::spawn: {
+            auto position = as_point(lua::check<Vector_t>(L, 2));
+            auto velocity = opt_point(L, 3);
+            auto lifetime = static_cast<float>(luaL_optnumber(L, 4, Lou_Entities::forever));
+            auto id = self.spawn(position, velocity, lifetime);
+            if (!id) lua::error(L, id.error());
+            return lua::values(L, static_cast<double>(*id));
+        }
+        case Namecall_Atom::remove:
+            return lua::values(L, self.remove(static_cast<Lou_Entities::Id>(luaL_checkunsigned(L, 2))));
+        case Namecall_Atom::alive:
+            return lua::values(L, self.find(static_cast<Lou_Entities::Id>(luaL_checkunsigned(L, 2))).has_value());
+        case Namecall_Atom::count:
+            return lua::values(L, static_cast<double>(self.size()));
+        case Namecall_Atom::clear:
+            self.clear();
+            return None;
+        case Namecall_Atom::expired:
+            return callback_handle(L, self.expired);
+        case Namecall_Atom::position: {
+            auto p = self.position[check_entity(L, self, 2)];
+            lua_pushvector(L, p.x, p.y, 0, 0);
+            return Value;
+        }
+        case Namecall_Atom::velocity: {
+            auto v = self.velocity[check_entity(L, self, 2)];
+            lua_pushvector(L, v.x, v.y, 0, 0);
+            return Value;
+        }
+        case Namecall_Atom::lifetime:
+            return lua::values(L, self.lifetime[check_entity(L, self, 2)]);
+        case Namecall_Atom::set_position:
+            self.position[check_entity(L, self, 2)] = as_point(lua::check<Vector_t>(L, 3));
+            return None;
+        case Namecall_Atom::set_velocity:
+            self.velocity[check_entity(L, self, 2)] = as_point(lua::check<Vector_t>(L, 3));
+            return None;
+        case Namecall_Atom::set_lifetime:
+            self.lifetime[check_entity(L, self, 2)] = static_cast<float>(luaL_optnumber(L, 3, Lou_Entities::forever));
+            return None;
+        case Namecall_Atom::set_sprite: {
+            const size_t index = check_entity(L, self, 2);
+            auto& texture = to_tagged<Texture>(L, 3);
+            auto size = lua_isnoneornil(L, 4) ? texture.size : as_point(lua::check<Vector_t>(L, 4));
+            self.set_sprite(L, index, 3, size, static_cast<float>(luaL_optnumber(L, 5, 0)));
+            return None;
+        }
+        default: break;
+    }
+    err_invalid_method<Tag::Lou_Entities>(L, atom);
+}
+void Lou_Entities::push_metatable(lua_State* L) {
+    constexpr luaL_Reg meta[] = {
+        {"__namecall", entities_namecall},
+        {nullptr, nullptr}
+    };
+    basic_push_metatable<Tag::Lou_Entities>(L, meta);
+}
+// Lou_Particles meta implementation
+static auto particles_namecall(lua_State* L) -> int {
+    auto& self = to_tagged<Tag::Lou_Particles>(L, 1);
+    auto [atom, name] = lua::namecall_atom<Namecall_Atom>(L);
+    switch (atom) {
+        case Namecall_Atom::emitter: {
+            const auto capacity = static_cast<size_t>(luaL_checkunsigned(L, 2));
+            if (capacity == 0) lua::arg_error(L, 2, "capacity must be greater than 0");
+            auto& emitter = make_tagged<Tag::Lou_Emitter>(L, capacity, self.next_seed++);
+            self.emitters.push_back(&emitter);
+            return Value;
+        }
+        default: break;
+    }
+    err_invalid_method<Tag::Lou_Particles>(L, atom);
+}
+void Lou_Particles::push_metatable(lua_State* L) {
+    constexpr luaL_Reg meta[] = {
+        {"__namecall", particles_namecall},
+        {nullptr, nullptr}
+    };
+    basic_push_metatable<Tag::Lou_Particles>(L, meta);
+}
+// Lou_Emitter meta implementation
+static auto check_range(lua_State* L, int idx) -> Lou_Emitter::Range {
+    const auto min = static_cast<float>(luaL_checknumber(L, idx));
+    return {min, static_cast<float>(luaL_optnumber(L, idx + 1, min))};
+}
+static auto emitter_namecall(lua_State* L) -> int {
+    auto& self = to_tagged<Tag::Lou_Emitter>(L, 1);
+    auto [atom, name] = lua::namecall_atom<Namecall_Atom>(L);
+    switch (atom) {
+        case Namecall_Atom::burst: {
+            auto position = as_point(lua::check<Vector_t>(L, 2));
+            const auto count = static_cast<size_t>(luaL_checkunsigned(L, 3));
+            return lua::values(L, static_cast<double>(self.burst(position, count)));
+        }
+        case Namecall_Atom::count:
+            return lua::values(L, static_cast<double>(self.live));
+        case Namecall_Atom::clear:
+            self.live = 0;
+            return None;
+        case Namecall_Atom::render:
+            check_sdl(L, self.render(Lou_State::from(L).renderer));
+            return None;
+        case Namecall_Atom::set_lifetime:
+            self.lifetime = check_range(L, 2);
+            return None;
+        case Namecall_Atom::set_speed:
+            self.speed = check_range(L, 2);
+            return None;
+        case Namecall_Atom::set_sizes:
+            self.size = check_range(L, 2);
+            return None;
+        case Namecall_Atom::set_direction:
+            self.direction = static_cast<float>(luaL_checknumber(L, 2));
+            self.spread = static_cast<float>(luaL_optnumber(L, 3, 0));
+            return None;
+        case Namecall_Atom::set_gravity:
+            self.gravity = as_point(lua::check<Vector_t>(L, 2));
+            return None;
+        case Namecall_Atom::set_colors:
+            self.start_color = as_color(lua::check<Vector_t>(L, 2));
+            self.end_color = lua_isnoneornil(L, 3) ? self.start_color : as_color(lua::check<Vector_t>(L, 3));
+            return None;
+        case Namecall_Atom::set_texture:
+            self.texture = lua_isnoneornil(L, 2) ? nullptr : &to_tagged<Texture>(L, 2);
+            self.texture_ref = self.texture ? lua::Ref(L, 2) : lua::Ref{};
+            return None;
+        default: break;
+    }
+    err_invalid_method<Tag::Lou_Emitter>(L, atom);
+}
+static void emitter_destructor(lua_State* L, void* userdata) {
+    auto emitter = static_cast<Lou_Emitter*>(userdata);
+    Lou_State::from(L).particles.forget(emitter);
+    emitter->~Lou_Emitter();
+}
+void Lou_Emitter::push_metatable(lua_State* L) {
+    if (new_metatable<Tag::Lou_Emitter>(L)) {
+        set_destructor<Tag::Lou_Emitter, emitter_destructor>(L);
+        const luaL_Reg meta[] = {
+            {"__namecall", emitter_namecall},
+            {nullptr, nullptr}
+        };
+        luaL_register(L, nullptr, meta);
+        set_type_metamethod<Tag::Lou_Emitter>(L);
+    }
+}
+// Lou_Tilemap meta implementation
+static auto check_tile_position(lua_State* L, Lou_Tilemap& self, int idx) -> std::pair<int, int> {
+    auto [x, y] = lua::check_args<int, int>(L, idx);
+    if (x < 0 or x >= self.width or y < 0 or y >= self.height) {
+        lua::arg_error(L, idx, "tile ({}, {}) is outside of the map", x, y);
+    }
+    return {x, y};
+}
+static auto check_tile(lua_State* L, Lou_Tilemap& self, int idx) -> uint16_t {
+    const int tile = luaL_checkinteger(L, idx);
+    if (tile < 0 or tile > self.tile_count() or tile > UINT16_MAX) {
+        lua::arg_error(L, idx, "tile {} is not in the tileset", tile);
+    }
+    return static_cast<uint16_t>(tile);
+}
+static auto tilemap_namecall(lua_State* L) -> int {
+    auto& self = to_tagged<Tag::Lou_Tilemap>(L, 1);
+    auto [atom, name] = lua::namecall_atom<Namecall_Atom>(L);
+    switch (atom) {
+        case Namecall_Atom::set: {
+            auto [x, y] = check_tile_position(L, self, 2);
+            self.set(x, y, check_tile(L, self, 4));
+            return None;
+        }
+        case Namecall_Atom::get: {
+            auto [x, y] = check_tile_position(L, self, 2);
+            return lua::values(L, self.tiles[static_cast<size_t>(y) * self.width + x]);
+        }
+        case Namecall_Atom::fill: {
+            auto area = as_rect(lua::check<Vector_t>(L, 2));
+            const auto tile = check_tile(L, self, 3);
+            const int x0 = std::max(static_cast<int>(area.x), 0);
+            const int y0 = std::max(static_cast<int>(area.y), 0);
+            const int x1 = std::min(static_cast<int>(area.x + area.w), self.width);
+            const int y1 = std::min(static_cast<int>(area.y + area.h), self.height);
+            for (int y = y0; y < y1; ++y) {
+                for (int x = x0; x < x1; ++x) self.set(x, y, tile);
+            }
+            return None;
+        }
+        case Namecall_Atom::size:
+            return lua::values(L, self.width, self.height);
+        case Namecall_Atom::invalidate:
+            self.invalidate();
+            return None;
+        case Namecall_Atom::render: {
+            auto& renderer = Lou_State::from(L).renderer;
+            auto position = opt_point(L, 2);
+            SDL_FRect view;
+            if (lua_isnoneornil(L, 3)) {
+                int w, h;
+                check_sdl(L, SDL_GetCurrentRenderOutputSize(renderer.get(), &w, &h));
+                view = {0, 0, static_cast<float>(w), static_cast<float>(h)};
+            } else {
+                view = as_rect(lua::check<Vector_t>(L, 3));
+            }
+            auto rendered = self.render(renderer, position, view);
+            if (!rendered) lua::error(L, rendered.error());
+            return None;
+        }
+        default: break;
+    }
+    err_invalid_method<Tag::Lou_Tilemap>(L, atom);
+}
+// chunk textures might still be waiting in the sprite batch
+static void tilemap_destructor(lua_State* L, void* userdata) {
+    auto tilemap = static_cast<Lou_Tilemap*>(userdata);
+    auto& renderer = Lou_State::from(L).renderer;
+    for (auto& chunk : tilemap->chunks) {
+        if (chunk.texture) renderer.release(chunk.texture->get());
+    }
+    tilemap->~Lou_Tilemap();
+}
+void Lou_Tilemap::push_metatable(lua_State* L) {
+    if (new_metatable<Tag::Lou_Tilemap>(L)) {
+        set_destructor<Tag::Lou_Tilemap, tilemap_destructor>(L);
+        const luaL_Reg meta[] = {
+            {"__namecall", tilemap_namecall},
+            {nullptr, nullptr}
+        };
+        luaL_register(L, nullptr, meta);
+        set_type_metamethod<Tag::Lou_Tilemap>(L);
+    }
+}
+// Lou_Spatial_Hash meta implementation
+static auto check_ids(lua_State* L, int idx) -> std::span<Lou_Spatial_Hash::Id> {
+    size_t len{};
+    auto data = static_cast<Lou_Spatial_Hash::Id*>(luaL_checkbuffer(L, idx, &len));
+    return {data, len / sizeof(Lou_Spatial_Hash::Id)};
+}
+// infinite or nan coordinates have no cells to go into
+static auto check_finite_rect(lua_State* L, int idx) -> SDL_FRect {
+    const auto v = lua::check<Vector_t>(L, idx);
+    if (not std::ranges::all_of(v, [](float e) {return std::isfinite(e);})) lua::arg_error(L, idx, "rect must be finite");
+    return as_rect(v);
+}
+static auto check_body(lua_State* L, Lou_Spatial_Hash& self, int idx) -> Lou_Spatial_Hash::Id {
+    const auto id = static_cast<Lou_Spatial_Hash::Id>(luaL_checkunsigned(L, idx));
+    if (not self.contains(id)) lua::arg_error(L, idx, "body {} does not exist", id);
+    return id;
+}
+static auto spatial_hash_namecall(lua_State* L) -> int {
+    auto& self = to_tagged<Tag::Lou_Spatial_Hash>(L, 1);
+    auto [atom, name] = lua::namecall_atom<Namecall_Atom>(L);
+    switch (atom) {
+        case Namecall_Atom::insert:
+            return lua::values(L, static_cast<double>(self.insert(check_finite_rect(L, 2))));
+        case Namecall_Atom::move: {
+            const auto id = check_body(L, self, 2);
+            self.move(id, check_finite_rect(L, 3));
+            return None;
+        }
+        case Namecall_Atom::remove:
+            self.remove(check_body(L, self, 2));
+            return None;
+        case Namecall_Atom::count:
+            return lua::values(L, static_cast<double>(self.count()));
+        case Namecall_Atom::query_point: {
+            auto point = as_point(lua::check<Vector_t>(L, 2));
+            if (not (std::isfinite(point.x) and std::isfinite(point.y))) lua::arg_error(L, 2, "point must be finite");
+            return lua::values(L, static_cast<double>(self.query_point(point, check_ids(L, 3))));
+        }
+        case Namecall_Atom::query_rect: {
+            auto rect = check_finite_rect(L, 2);
+            return lua::values(L, static_cast<double>(self.query_rect(rect, check_ids(L, 3))));
+        }
+        case Namecall_Atom::pairs:
+            return lua::values(L, static_cast<double>(self.pairs(check_ids(L, 2))));
+        default: break;
+    }
+    err_invalid_method<Tag::Lou_Spatial_Hash>(L, atom);
+}
+void Lou_Spatial_Hash::push_metatable(lua_State* L) {
+    if (new_metatable<Tag::Lou_Spatial_Hash>(L)) {
+        set_destructor<Tag::Lou_Spatial_Hash>(L);
+        const luaL_Reg meta[] = {
+            {"__namecall", spatial_hash_namecall},
+            {nullptr, nullptr}
+        };
+        luaL_register(L, nullptr, meta);
+        set_type_metamethod<Tag::Lou_Spatial_Hash>(L);
+    }
+}
+void Lou_Spatial_Hash::push_constructor(lua_State* L) {
+    auto constructor = [](lua_State* L) -> int {
+        const auto cell_size = lua::check<float>(L, 1);
+        if (cell_size <= 0) lua::arg_error(L, 1, "cell size must be greater than 0");
+        make_tagged<Tag::Lou_Spatial_Hash>(L, cell_size);
+        return 1;
+    };
+    lua_pushcfunction(L, constructor, "Spatial_Hash");
+}
+// Lou_Actors meta implementation
+static auto actors_namecall(lua_State* L) -> int {
+    auto& self = to_tagged<Tag::Lou_Actors>(L, 1);
+    auto [atom, name] = lua::namecall_atom<Namecall_Atom>(L);
+    switch (atom) {
+        case Namecall_Atom::spawn: {
+            std::filesystem::path script{luaL_checkstring(L, 2)};
+            if (not std::filesystem::is_regular_file(script)) {
+                lua::arg_error(L, 2, "'{}' is not a file", script.string());
+            }
+            auto& actor = make_tagged<Tag::Lou_Actor>(L, std::move(script), Lou_State::from(L).console);
+            self.running.push_back({.actor = &actor, .ref = lua::Ref(L, -1)});
+            return Value;
+        }
+        case Namecall_Atom::count:
+            return lua::values(L, static_cast<double>(self.running.size()));
+        default: break;
+    }
+    err_invalid_method<Tag::Lou_Actors>(L, atom);
+}
+void Lou_Actors::push_metatable(lua_State* L) {
+    constexpr luaL_Reg meta[] = {
+        {"__namecall", actors_namecall},
+        {nullptr, nullptr}
+    };
+    basic_push_metatable<Tag::Lou_Actors>(L, meta);
+}
+// Lou_Actor meta implementation
+static auto actor_namecall(lua_State* L) -> int {
+    auto& self = to_tagged<Tag::Lou_Actor>(L, 1);
+    auto [atom, name] = lua::namecall_atom<Namecall_Atom>(L);
+    switch (atom) {
+        case Namecall_Atom::send: {
+            auto message = Lou_Actor::serialize(L, 2);
+            if (not message) lua::error(L, message.error());
+            self.send(std::move(*message));
+            return None;
+        }
+        case Namecall_Atom::received: {
+            auto handle = Lou_Callback_Handle::bind(self.received, L, 2);
+            handle.owner = lua::Ref(L, 1);
+            make_tagged<Tag::Lou_Callback_Handle>(L, std::move(handle));
+            return Value;
+        }
+        case Namecall_Atom::alive:
+            return lua::values(L, not self.finished.load(std::memory_order_acquire));
+        case Namecall_Atom::stop:
+            self.stop();
+            return None;
+        default: break;
+    }
+    err_invalid_method<Tag::Lou_Actor>(L, atom);
+}
+void Lou_Actor::push_metatable(lua_State* L) {
+    if (new_metatable<Tag::Lou_Actor>(L)) {
+        set_destructor<Tag::Lou_Actor>(L);
+        const luaL_Reg meta[] = {
+            {"__namecall", actor_namecall},
+            {nullptr, nullptr}
+        };
+        luaL_register(L, nullptr, meta);
+        set_type_metamethod<Tag::Lou_Actor>(L);
+    }
+}
+// Lou_Jobs meta implementation
+static auto check_lanes(lua_State* L, int idx) -> Lou_Jobs::Lanes_t {
+    auto v = lua::check<Vector_t>(L, idx);
+    return {v[0], v[1], v[2], v[3]};
+}
+static auto run_kernel(lua_State* L) -> int {
+    size_t len{};
+    auto data = static_cast<float*>(luaL_checkbuffer(L, 2, &len));
+    const auto stride = static_cast<size_t>(luaL_checkinteger(L, 3));
+    if (stride < 1) lua::arg_error(L, 3, "stride must be at least 1");
+    const std::span<float> floats{data, len / sizeof(float)};
+    auto [kernel, kernel_name] = lua::index_atom<Namecall_Atom>(L, 4);
+    auto require_lanes = [&](size_t lanes) {
+        if (stride < lanes) lua::arg_error(L, 3, "'{}' needs a stride of at least {}", kernel_name, lanes);
+    };
+    switch (kernel) {
+        case Namecall_Atom::translate:
+            Lou_Jobs::translate(floats, stride, check_lanes(L, 5));
+            return None;
+        case Namecall_Atom::scale:
+            Lou_Jobs::scale(floats, stride, check_lanes(L, 5));
+            return None;
+        case Namecall_Atom::clamp:
+            Lou_Jobs::clamp(floats, stride, check_lanes(L, 5), check_lanes(L, 6));
+            return None;
+        case Namecall_Atom::integrate:
+            require_lanes(4);
+            Lou_Jobs::integrate(floats, stride, lua::check<float>(L, 5));
+            return None;
+        case Namecall_Atom::transform:
+            require_lanes(2);
+            Lou_Jobs::transform(floats, stride, check_lanes(L, 5), opt_point(L, 6));
+            return None;
+        case Namecall_Atom::rotate: {
+            require_lanes(2);
+            const float radians = lua::check<float>(L, 5);
+            const auto pivot = opt_point(L, 6);
+            const float c = std::cos(radians);
+            const float s = std::sin(radians);
+            Lou_Jobs::transform(floats, stride, {c, -s, s, c}, {
+                pivot.x - (c * pivot.x - s * pivot.y),
+                pivot.y - (s * pivot.x + c * pivot.y),
+            });
+            return None;
+        }
+        default: break;
+    }
+    lua::arg_error(L, 4, "unknown kernel '{}'", kernel_name);
+}
+static auto jobs_namecall(lua_State* L) -> int {
+    auto [atom, name] = lua::namecall_atom<Namecall_Atom>(L);
+    switch (atom) {
+        case Namecall_Atom::parallel_for:
+            return run_kernel(L);
+        case Namecall_Atom::thread_count:
+            return lua::values(L, static_cast<double>(jobs::thread_count()));
+        case Namecall_Atom::set_thread_count: {
+            const int count = luaL_checkinteger(L, 2);
+            if (count < 0) lua::arg_error(L, 2, "thread count can't be negative");
+            jobs::set_thread_count(static_cast<size_t>(count));
+            return None;
+        }
+        default: break;
+    }
+    err_invalid_method<Tag::Lou_Jobs>(L, atom);
+}
+void Lou_Jobs::push_metatable(lua_State* L) {
+    constexpr luaL_Reg meta[] = {
+        {"__namecall", jobs_namecall},
+        {nullptr, nullptr}
+    };
+    basic_push_metatable<Tag::Lou_Jobs>(L, meta);
+}
 // Lou_State meta implementation
-static auto state_index(lua_State* L) -> int {
-    auto& state = to_tagged<State>(L, 1);
+static auto state_missing_field(lua_State* L) -> int {
     std::string_view index = luaL_checkstring(L, 2);
-    if (index == "console") {
-        // no need to cache a lua_ref, cause it is a field in the global 'lou'.
-        // when sandboxed this automatically resolves to 1 invocation.
-        // Pretty cool. Only works with a global __index, however.
-        push_tagged(L, state.console);
-        return Value;
-    } else if (index == "keyboard") {
-        push_tagged(L, state.keyboard);
-        return Value;
-    } else if (index == "mouse") {
-        push_tagged(L, state.mouse);
-        return Value;
-    } else if (index == "window") {
-        push_tagged(L, state.window);
-        return Value;
-    } else if (index == "renderer") {
-        push_tagged(L, state.renderer);
-        return Value;
-    } else if (index == "texture") {
-        push_tagged(L, state.texture);
-        return Value;
-    }
     lua::error(L, "invalid field '{}'", index);
 }
 static auto state_newindex(lua_State *L) -> int {
@@ -549,7 +1253,7 @@ static auto state_namecall(lua_State *L) -> int {
     auto& engine = to_tagged<State>(L, 1);
     int atom{};
     lua_namecallatom(L, &atom);
-    logger.log("atom is {}, {}", atom, compile_time::enum_item<Namecall_Atom>(atom).name);
+    logger.debug("atom is {}, {}", atom, compile_time::enum_item<Namecall_Atom>(atom).name);
     auto bound_callback = [&L] (auto& cb, auto idx) {
         auto handle = Lou_Callback_Handle::bind(cb, L, idx);
         make_tagged<Tag::Lou_Callback_Handle>(L, std::move(handle));
@@ -560,6 +1264,34 @@ static auto state_namecall(lua_State *L) -> int {
             return callback_handle(L, engine.on_update);
         case Namecall_Atom::on_render:
             return callback_handle(L, engine.on_render);
+        case Namecall_Atom::request_redraw:
+            engine.frame.redraw_requested = true;
+            return None;
+        case Namecall_Atom::set_idle_mode:
+            engine.frame.idle_mode = lua::check<bool>(L, 2);
+            engine.frame.idle_timeout_ms = luaL_optinteger(L, 3, engine.frame.idle_timeout_ms);
+            engine.frame.redraw_requested = true;
+            return None;
+        case Namecall_Atom::typed_results:
+            return lua::values(L, typed_results_report());
+        case Namecall_Atom::frame_stats:
+            return lua::values(L,
+                static_cast<double>(engine.frame.rendered),
+                static_cast<double>(engine.frame.skipped)
+            );
+        case Namecall_Atom::font_stats: {
+            auto stats = engine.fonts.stats();
+            return lua::values(L,
+                static_cast<double>(stats.files),
+                static_cast<double>(stats.fonts),
+                static_cast<double>(stats.file_bytes)
+            );
+        }
+        case Namecall_Atom::dump_refs: {
+            auto dumped = engine.refs.dump(L, luaL_optstring(L, 2, Lou_Refs::default_file));
+            if (not dumped) lua::error(L, dumped.error());
+            return lua::values(L, static_cast<double>(*dumped));
+        }
         default: break;
     }
     err_invalid_method<State>(L, atom);
@@ -567,7 +1299,6 @@ static auto state_namecall(lua_State *L) -> int {
 auto Lou_State::push_metatable(lua_State *L) -> void {
     if (new_metatable<State>(L)) {
         const luaL_Reg meta[] = {
-            {"__index", state_index},
             {"__newindex", state_newindex},
             {"__namecall", state_namecall},
             {nullptr, nullptr}
@@ -576,3 +1307,35 @@ auto Lou_State::push_metatable(lua_State *L) -> void {
         set_type_metamethod<State>(L);
     }
 }
+// the subsystems never move, so their userdata get pushed once into a
+// readonly table that serves as __index instead of being created per access.
+auto Lou_State::bind_subsystems(lua_State* L) -> void {
+    push_metatable(L);
+    lua_newtable(L);
+    auto field = [L](const char* name, auto& subsystem) {
+        using Subsystem = std::remove_cvref_t<decltype(subsystem)>;
+        static_assert(is_handle_type<Tag_For<Subsystem>>, "subsystems must be listed in handle_types");
+        push_tagged(L, subsystem);
+        lua_setfield(L, -2, name);
+    };
+    field("console", console);
+    field("keyboard", keyboard);
+    field("mouse", mouse);
+    field("window", window);
+    field("renderer", renderer);
+    field("texture", texture);
+    field("math", math);
+    field("trace", trace);
+    field("entities", entities);
+    field("particles", particles);
+    field("actors", actors);
+    field("jobs", jobs);
+    field("profiler", profiler);
+    lua_newtable(L);
+    lua_pushcfunction(L, state_missing_field, "state_missing_field");
+    lua_setfield(L, -2, "__index");
+    lua_setmetatable(L, -2);
+    lua_setreadonly(L, -1, true);
+    lua_setfield(L, -2, "__index");
+    lua_pop(L, 1);
+}
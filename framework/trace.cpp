@@ -0,0 +1,181 @@
+#include "trace.hpp"
+#include <array>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace tracing {
+namespace {
+constexpr size_t buffer_capacity = 1 << 15;
+// start() bumps the generation, a buffer still tagged with an older one holds
+// events of a previous capture and is reset by its owner on the next record.
+std::atomic<uint64_t> generation{0};
+struct Thread_Buffer {
+    std::array<Event, buffer_capacity> events;
+    // head and generation are only written by the owning thread, and dump
+    // only reads them after stop() waited for `writing` to drop.
+    std::atomic<size_t> head{0};
+    std::atomic<uint64_t> generation{0};
+    std::atomic<bool> writing{false};
+    std::string name;
+    int id;
+    // the owning thread exited, the buffer waits for another one to take it.
+    bool retired{false};
+};
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Thread_Buffer>> buffers;
+    std::unordered_set<std::string> names;
+    int next_id{1};
+};
+auto registry() -> Registry& {
+    static Registry instance;
+    return instance;
+}
+// hands the buffer back to the registry when its thread exits, so short lived
+// workers reuse buffers instead of leaving one behind each.
+class Buffer_Owner {
+    Thread_Buffer* buffer_{nullptr};
+public:
+    std::string name;
+    Buffer_Owner() = default;
+    Buffer_Owner(const Buffer_Owner&) = delete;
+    Buffer_Owner& operator=(const Buffer_Owner&) = delete;
+    ~Buffer_Owner() {
+        if (not buffer_) return;
+        std::scoped_lock lock{registry().mutex};
+        buffer_->retired = true;
+    }
+    auto buffer() const -> Thread_Buffer* {
+        return buffer_;
+    }
+    auto acquire() -> Thread_Buffer& {
+        if (buffer_) return *buffer_;
+        auto& r = registry();
+        std::scoped_lock lock{r.mutex};
+        // rather take one whose events are from an older capture than one a
+        // thread that exited during this capture filled.
+        const uint64_t current = tracing::generation.load(std::memory_order_relaxed);
+        Thread_Buffer* reused{nullptr};
+        for (auto& b : r.buffers) {
+            if (not b->retired) continue;
+            reused = b.get();
+            if (b->generation.load(std::memory_order_relaxed) != current) break;
+        }
+        if (reused) {
+            reused->retired = false;
+            reused->head.store(0, std::memory_order_relaxed);
+            reused->generation.store(0, std::memory_order_relaxed);
+            buffer_ = reused;
+        } else {
+            buffer_ = r.buffers.emplace_back(std::make_unique<Thread_Buffer>()).get();
+        }
+        buffer_->id = r.next_id++;
+        buffer_->name = name.empty() ? std::format("thread {}", buffer_->id) : name;
+        return *buffer_;
+    }
+};
+thread_local Buffer_Owner owner;
+auto append_escaped(std::string& out, std::string_view str) -> void {
+    for (char c : str) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) continue;
+                out += c;
+        }
+    }
+}
+}
+
+auto intern(std::string_view name) -> const char* {
+    auto& r = registry();
+    std::scoped_lock lock{r.mutex};
+    return r.names.emplace(name).first->c_str();
+}
+
+auto record(const char* name, uint64_t start_ns, uint64_t end_ns) -> void {
+    if (not enabled()) return;
+    auto& buffer = owner.acquire();
+    // pairs with stop(): either it sees `writing` and waits, or this sees
+    // the capture already stopped.
+    buffer.writing.store(true, std::memory_order_seq_cst);
+    if (capturing.load(std::memory_order_seq_cst)) {
+        const uint64_t current = generation.load(std::memory_order_relaxed);
+        if (buffer.generation.load(std::memory_order_relaxed) != current) {
+            buffer.head.store(0, std::memory_order_relaxed);
+            buffer.generation.store(current, std::memory_order_relaxed);
+        }
+        const size_t head = buffer.head.load(std::memory_order_relaxed);
+        buffer.events[head % buffer_capacity] = {name, start_ns, end_ns - start_ns};
+        buffer.head.store(head + 1, std::memory_order_relaxed);
+    }
+    buffer.writing.store(false, std::memory_order_release);
+}
+
+auto set_thread_name(std::string_view name) -> void {
+    owner.name = name;
+    auto buffer = owner.buffer();
+    if (not buffer) return;
+    std::scoped_lock lock{registry().mutex};
+    buffer->name = name;
+}
+
+auto start() -> void {
+    generation.fetch_add(1, std::memory_order_relaxed);
+    capturing.store(true, std::memory_order_seq_cst);
+}
+
+auto stop() -> void {
+    capturing.store(false, std::memory_order_seq_cst);
+    auto& r = registry();
+    std::scoped_lock lock{r.mutex};
+    for (auto& buffer : r.buffers) {
+        while (buffer->writing.load(std::memory_order_seq_cst)) std::this_thread::yield();
+    }
+}
+
+auto dump(const std::filesystem::path& file) -> std::expected<size_t, std::string> {
+    // events are only read once no thread can be writing them anymore.
+    stop();
+    std::string json{"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"};
+    size_t count{};
+    auto& r = registry();
+    {
+        std::scoped_lock lock{r.mutex};
+        const uint64_t current = generation.load(std::memory_order_relaxed);
+        for (auto& buffer : r.buffers) {
+            const size_t head = buffer->head.load(std::memory_order_relaxed);
+            if (head == 0 or buffer->generation.load(std::memory_order_relaxed) != current) continue;
+            json += std::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"", buffer->id);
+            append_escaped(json, buffer->name);
+            json += "\"}},\n";
+            const size_t first = head > buffer_capacity ? head - buffer_capacity : 0;
+            for (size_t i = first; i < head; ++i) {
+                const auto& e = buffer->events[i % buffer_capacity];
+                json += "{\"name\":\"";
+                append_escaped(json, e.name);
+                json += std::format(
+                    "\",\"cat\":\"lou\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}},\n",
+                    buffer->id,
+                    e.start_ns / 1000.0,
+                    e.duration_ns / 1000.0
+                );
+                ++count;
+            }
+        }
+    }
+    if (json.ends_with(",\n")) json.resize(json.size() - 2);
+    json += "\n]}\n";
+    std::ofstream out{file};
+    if (not out.is_open()) return std::unexpected(std::format("failed to open '{}'", file.string()));
+    out << json;
+    return count;
+}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// Scoped timeline events recorded into per-thread ring buffers and dumped
+// as chrome trace-event json (chrome://tracing, ui.perfetto.dev).
+// When capturing is disabled a scope costs a single relaxed atomic load.
+namespace tracing {
+struct Event {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+};
+inline std::atomic<bool> capturing{false};
+inline auto enabled() -> bool {
+    return capturing.load(std::memory_order_relaxed);
+}
+inline auto now() -> uint64_t {
+    using namespace std::chrono;
+    static const auto epoch = steady_clock::now();
+    return duration_cast<nanoseconds>(steady_clock::now() - epoch).count();
+}
+// names have to outlive the capture, string literals can be passed as is.
+auto intern(std::string_view name) -> const char*;
+auto record(const char* name, uint64_t start_ns, uint64_t end_ns) -> void;
+auto set_thread_name(std::string_view name) -> void;
+auto start() -> void;
+// returns once no thread is in the middle of recording an event.
+auto stop() -> void;
+// stops a running capture first, events still being written can't be read.
+auto dump(const std::filesystem::path& file) -> std::expected<size_t, std::string>;
+
+class Scope {
+    const char* name_;
+    uint64_t start_ns_{};
+public:
+    explicit Scope(const char* name): name_(enabled() ? name : nullptr) {
+        if (name_) start_ns_ = now();
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope() {
+        if (name_) record(name_, start_ns_, now());
+    }
+};
+}
+#define LOU_TRACE_CONCAT_IMPL(a, b) a##b
+#define LOU_TRACE_CONCAT(a, b) LOU_TRACE_CONCAT_IMPL(a, b)
+#define LOU_TRACE_SCOPE(name) ::tracing::Scope LOU_TRACE_CONCAT(trace_scope_, __LINE__){name}